@@ -37,6 +37,8 @@
 
 class File;
 
+typedef std::unordered_map<AsciiString, const ArchivedFileInfo *, rts::hash<AsciiString>, rts::equal_to<AsciiString> > ArchivedFileInfoLookup; ///< lookup key -> the file's entry in the directory tree
+
 /**
   *	An archive file is itself a collection of sub files. Each file inside the archive file
 	* has a unique name by which it can be accessed. The ArchiveFile object class is the
@@ -66,12 +68,16 @@ public:
 	void									getFileListInDirectory(const DetailedArchivedDirectoryInfo *dirInfo, const AsciiString& currentDirectory, const AsciiString& searchName, FilenameList &filenameList, Bool searchSubdirectories) const;
 
 	void									addFile(const AsciiString& path, const ArchivedFileInfo *fileInfo); ///< add this file to our directory tree.
+	const ArchivedFileInfoLookup&	getFileLookup( void ) const { return m_fileLookup; }	///< every file in the archive, by lookup key
+
+	static Bool						makeLookupKey(const AsciiString& filename, AsciiString& key); ///< turn a file name into the key the lookups are hashed on.  FALSE if it can never name an archived file.
 
 protected:
 	const ArchivedFileInfo *		getArchivedFileInfo(const AsciiString& filename) const;	///< return the ArchivedFileInfo from the directory tree.
 
 	File *m_file; ///< file pointer to the archive file on disk.  Kept open so we don't have to continuously open and close the file all the time.
 	DetailedArchivedDirectoryInfo m_rootDirectory;
+	ArchivedFileInfoLookup m_fileLookup;	///< flat index into m_rootDirectory so lookups don't have to walk it
 };
 
 #endif // __ARCHIVEFILE_H
\ No newline at end of file
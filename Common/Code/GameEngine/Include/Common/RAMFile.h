@@ -100,6 +100,7 @@ class RAMFile : public File
 
 		virtual Bool	open( File *file );																	///< Open file for fast RAM access
 		virtual Bool	openFromArchive(File *archiveFile, const AsciiString& filename, Int offset, Int size); ///< copy file data from the given file at the given offset for the given size.
+		Bool					openFromBuffer(Char *data, Int size, const AsciiString& filename); ///< take ownership of data (allocated with new[]) as the file's contents.
 		virtual Bool	copyDataToFile(File *localFile);										///< write the contents of the RAM file to the given local file.  This could be REALLY slow.
 
 		/**
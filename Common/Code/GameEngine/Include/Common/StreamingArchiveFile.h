@@ -53,6 +53,7 @@
 //----------------------------------------------------------------------------
 
 #include "Common/RAMFile.h"
+#include "Common/CriticalSection.h"
 
 //----------------------------------------------------------------------------
 //           Forward References
@@ -81,6 +82,7 @@ class StreamingArchiveFile : public RAMFile
 		Int						m_startingPos;								///< My starting position in the archive
 		Int						m_size;												///< My length
 		Int						m_curPos;											///< My current position.
+		CriticalSection	*m_archiveLock;								///< Held across each seek & read of m_file, since other threads share it
 		
 	public:
 		
@@ -102,6 +104,7 @@ class StreamingArchiveFile : public RAMFile
 
 		virtual Bool	open( File *file );																	///< Open file for fast RAM access
 		virtual Bool	openFromArchive(File *archiveFile, const AsciiString& filename, Int offset, Int size); ///< copy file data from the given file at the given offset for the given size.
+		void					setArchiveLock(CriticalSection *lock) { m_archiveLock = lock; }	///< the lock that guards the archive's m_file, if other threads read it
 		virtual Bool	copyDataToFile(File *localFile) { DEBUG_CRASH(("Are you sure you meant to copyDataToFile on a streaming file?")); return FALSE; }
 
 		virtual char* readEntireAndClose() { DEBUG_CRASH(("Are you sure you meant to readEntireAndClose on a streaming file?")); return NULL; }
@@ -119,8 +119,49 @@ void ArchiveFile::addFile(const AsciiString& path, const ArchivedFileInfo *fileI
 		temp.nextToken(&token, "\\/");
 	}
 
-	dirInfo->m_files[fileInfo->m_filename] = *fileInfo;
-	//path.concat(fileInfo->m_filename);
+	ArchivedFileInfo *info = &(dirInfo->m_files[fileInfo->m_filename]);
+	*info = *fileInfo;
+
+	// debugpath is the directories joined with '\\', so this is exactly the key
+	// makeLookupKey builds for a name that walks to this entry.
+	debugpath.concat(fileInfo->m_filename);
+	m_fileLookup[debugpath] = info;
+}
+
+/**
+	* Lower case the name and split it the way the directory tree walks always
+	* have: tokens are directories until we hit one with a '.' in it and no more
+	* '.'s after it, that one is the file.  The key is those tokens joined with
+	* '\\', which is unique per (directories, file) pair, so a hash of keys finds
+	* exactly what walking the tree would have found.
+	*/
+Bool ArchiveFile::makeLookupKey(const AsciiString& filename, AsciiString& key)
+{
+	AsciiString path;
+	path = filename;
+	path.toLower();
+	AsciiString token;
+
+	key.clear();
+
+	path.nextToken(&token, "\\/");
+
+	while ((token.find('.') == NULL) || (path.find('.') != NULL)) {
+		// ran out of path before finding the file, the tree walk could never match this either.
+		if (token.isEmpty()) {
+			return FALSE;
+		}
+
+		key.concat(token);
+		key.concat('\\');
+
+		if (!path.nextToken(&token, "\\/")) {
+			return FALSE;
+		}
+	}
+
+	key.concat(token);
+	return TRUE;
 }
 
 void ArchiveFile::getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList &filenameList, Bool searchSubdirectories) const
@@ -198,34 +239,15 @@ void ArchiveFile::attachFile(File *file)
 
 const ArchivedFileInfo * ArchiveFile::getArchivedFileInfo(const AsciiString& filename) const
 {
-	AsciiString path;
-	path = filename;
-	path.toLower();
-	AsciiString token;
-
-	const DetailedArchivedDirectoryInfo *dirInfo = &m_rootDirectory;
-
-	path.nextToken(&token, "\\/");
-
-	while ((token.find('.') == NULL) || (path.find('.') != NULL)) {
-
-		DetailedArchivedDirectoryInfoMap::const_iterator it = dirInfo->m_directories.find(token);
-		if (it != dirInfo->m_directories.end())
-		{
-			dirInfo = &it->second; 
-		}
-		else
-		{
-			return NULL;
-		}
-
-		path.nextToken(&token, "\\/");
+	AsciiString key;
+	if (!makeLookupKey(filename, key)) {
+		return NULL;
 	}
 
-	ArchivedFileInfoMap::const_iterator it = dirInfo->m_files.find(token);
-	if (it != dirInfo->m_files.end())
+	ArchivedFileInfoLookup::const_iterator it = m_fileLookup.find(key);
+	if (it != m_fileLookup.end())
 	{
-		return &it->second;
+		return it->second;
 	}
 	else
 	{
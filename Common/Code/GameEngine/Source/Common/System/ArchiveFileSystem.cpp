@@ -125,49 +125,25 @@ ArchiveFileSystem::~ArchiveFileSystem()
 
 void ArchiveFileSystem::loadIntoDirectoryTree(const ArchiveFile *archiveFile, const AsciiString& archiveFilename, Bool overwrite)
 {
-
-	FilenameList filenameList;
-
-	archiveFile->getFileListInDirectory(AsciiString(""), AsciiString(""), AsciiString("*"), filenameList, TRUE);
-
-	FilenameListIter it = filenameList.begin();
-
-	while (it != filenameList.end()) {
-		// add this filename to the directory tree.
-		AsciiString path = *it;
-		path.toLower();
-		AsciiString token;
-		AsciiString debugpath;
-
-		ArchivedDirectoryInfo *dirInfo = &m_rootDirectory;
-
-		Bool infoInPath;
-		infoInPath = path.nextToken(&token, "\\/");
-
-		while (infoInPath && (!token.find('.') || path.find('.'))) {
-			ArchivedDirectoryInfoMap::iterator tempiter = dirInfo->m_directories.find(token);
-			if (tempiter == dirInfo->m_directories.end()) 
-			{
-				dirInfo->m_directories[token].clear();
-				dirInfo->m_directories[token].m_directoryName = token;
-			}
-
-			dirInfo = &(dirInfo->m_directories[token]);
-			debugpath.concat(token);
-			debugpath.concat('\\');
-			infoInPath = path.nextToken(&token, "\\/");
+	// the archive already has every file keyed by its full path, so there's no need to
+	// list and re-split its directory tree.  the archive keys are raw paths though, and
+	// the lookup splits a path by its '.'s, so they still go through makeLookupKey.
+	const ArchivedFileInfoLookup& fileLookup = archiveFile->getFileLookup();
+	m_fileLocations.reserve(m_fileLocations.size() + fileLookup.size());
+
+	AsciiString key;
+	for (ArchivedFileInfoLookup::const_iterator it = fileLookup.begin(); it != fileLookup.end(); ++it) 
+	{
+		if (!ArchiveFile::makeLookupKey(it->first, key)) {
+			continue;
 		}
 
-		// token is the filename, and dirInfo is the directory that this file is in.
-		if (dirInfo->m_files.find(token) == dirInfo->m_files.end() || overwrite) {
-			AsciiString path2;
-			path2 = debugpath;
-			path2.concat(token);
-//			DEBUG_LOG(("ArchiveFileSystem::loadIntoDirectoryTree - adding file %s, archived in %s\n", path2.str(), archiveFilename.str()));
-			dirInfo->m_files[token] = archiveFilename;
+		if (overwrite) {
+			m_fileLocations[key] = archiveFilename;
+		} else {
+			m_fileLocations.insert(ArchivedFileLocationMap::value_type(key, archiveFilename));
 		}
-
-		it++;
+//		DEBUG_LOG(("ArchiveFileSystem::loadIntoDirectoryTree - adding file %s, archived in %s\n", key.str(), archiveFilename.str()));
 	}
 }
 
@@ -200,34 +176,12 @@ void ArchiveFileSystem::loadMods() {
 
 Bool ArchiveFileSystem::doesFileExist(const Char *filename) const
 {
-	AsciiString path = filename;
-	path.toLower();
-	AsciiString token;
-
-	const ArchivedDirectoryInfo *dirInfo = &m_rootDirectory;
-
-	path.nextToken(&token, "\\/");
-
-	while (!token.find('.') || path.find('.')) 
-	{
-		ArchivedDirectoryInfoMap::const_iterator tempiter = dirInfo->m_directories.find(token);
-		if (tempiter != dirInfo->m_directories.end()) 
-		{
-			dirInfo = &tempiter->second;
-			path.nextToken(&token, "\\/");
-		}
-		else
-		{
-			// the directory doesn't exist, so return false
-			return FALSE;
-		}
-	}
-
-	// token is the filename, and dirInfo is the directory that this file is in.
-	if (dirInfo->m_files.find(token) == dirInfo->m_files.end()) {
+	AsciiString key;
+	if (!ArchiveFile::makeLookupKey(AsciiString(filename), key)) {
 		return FALSE;
 	}
-	return TRUE;
+
+	return m_fileLocations.find(key) != m_fileLocations.end();
 }
 
 File * ArchiveFileSystem::openFile(const Char *filename, Int access /* = 0 */) 
@@ -266,47 +220,13 @@ Bool ArchiveFileSystem::getFileInfo(const AsciiString& filename, FileInfo *fileI
 
 AsciiString ArchiveFileSystem::getArchiveFilenameForFile(const AsciiString& filename) const
 {
-	AsciiString path;
-	path = filename;
-	path.toLower();
-	AsciiString token;
-	AsciiString debugpath;
-
-	const ArchivedDirectoryInfo *dirInfo = &m_rootDirectory;
-
-	path.nextToken(&token, "\\/");
-
-	while (!token.find('.') || path.find('.')) {
-
-		ArchivedDirectoryInfoMap::const_iterator it = dirInfo->m_directories.find(token);
-		if (it != dirInfo->m_directories.end())
-		{
-			dirInfo = &it->second;
-		}
-		else
-		{
-			// the directory doesn't exist, so return NULL
-
-			// dump the directories;
-			//DEBUG_LOG(("directory %s not found in %s in archive file system\n", token.str(), debugpath.str()));
-			//DEBUG_LOG(("directories in %s in archive file system are:\n", debugpath.str()));
-			//ArchivedDirectoryInfoMap::const_iterator it = dirInfo->m_directories.begin();
-			//while (it != dirInfo->m_directories.end()) {
-			//	DEBUG_LOG(("\t%s\n", it->second.m_directoryName.str()));
-			//	it++;
-			//}
-			//DEBUG_LOG(("end of directory list.\n"));
-			return AsciiString::TheEmptyString;
-		}
-
-		debugpath.concat(token);
-		debugpath.concat('\\');
-
-		path.nextToken(&token, "\\/");
+	AsciiString key;
+	if (!ArchiveFile::makeLookupKey(filename, key)) {
+		return AsciiString::TheEmptyString;
 	}
 
-	ArchivedFileLocationMap::const_iterator it = dirInfo->m_files.find(token);
-	if (it != dirInfo->m_files.end())
+	ArchivedFileLocationMap::const_iterator it = m_fileLocations.find(key);
+	if (it != m_fileLocations.end())
 	{
 		return it->second;
 	}
@@ -314,7 +234,6 @@ AsciiString ArchiveFileSystem::getArchiveFilenameForFile(const AsciiString& file
 	{
 		return AsciiString::TheEmptyString;
 	}
-
 }
 
 void ArchiveFileSystem::getFileListInDirectory(const AsciiString& currentDirectory, const AsciiString& originalDirectory, const AsciiString& searchName, FilenameList &filenameList, Bool searchSubdirectories) const
@@ -201,4 +201,130 @@ void DoCompressTest( void )
 
 }
 
+//-------------------------------------------------------------------------------------------------
+// Corpus benchmark.  Drop real data (maps, saves, replays, w3d, tga, dds...) into a directory and
+// every codec gets run over every file, as a single block and framed at a few block sizes.  Each
+// run is checked for a clean round trip and written out as one csv row, so the results can be
+// sorted by file type when deciding what getPreferredCompression() should say for each.
+//-------------------------------------------------------------------------------------------------
+
+enum { BENCHMARK_PASSES = 3 };	///< best of this many, to keep the odd context switch out of the numbers
+
+// 0 is the legacy single block format
+static const Int s_benchmarkBlockSizes[] = { 0, 64*1024, COMPRESSION_DEFAULT_BLOCK_SIZE, 1024*1024 };
+static const Int s_benchmarkThreads[] = { 1, 4 };
+
+static Real getBenchmarkMBps( Int bytes, Int64 ticks, Int64 ticksPerSec )
+{
+	if (ticks <= 0)
+		return 0.0f;
+	return (Real)(bytes / (1024.0 * 1024.0) / ((double)ticks / (double)ticksPerSec));
+}
+
+void DoCompressBenchmark( const AsciiString& corpusDir, const char *resultsFile )
+{
+	FilenameList files;
+	TheFileSystem->getFileListInDirectory(corpusDir, AsciiString("*.*"), files, TRUE);
+	if (files.empty())
+	{
+		DEBUG_LOG(("DoCompressBenchmark - nothing to test in '%s'\n", corpusDir.str()));
+		return;
+	}
+
+	FILE *fp = fopen(resultsFile, "wt");
+	if (!fp)
+	{
+		DEBUG_CRASH(("DoCompressBenchmark - can't write '%s'\n", resultsFile));
+		return;
+	}
+	fprintf(fp, "file,class,codec,blockSize,threads,origBytes,compressedBytes,ratio,encodeMBps,decodeMBps,roundTrip\n");
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+
+	for (FilenameListIter it = files.begin(); it != files.end(); ++it)
+	{
+		File *f = TheFileSystem->openFile(it->str());
+		if (!f)
+			continue;
+
+		Int origSize = f->size();
+		if (origSize <= 0)
+		{
+			f->close();
+			continue;
+		}
+		UnsignedByte *buf = (UnsignedByte *)f->readEntireAndClose();
+		UnsignedByte *uncompressedBuf = NEW UnsignedByte[origSize];
+
+		AsciiString assetClass = it->reverseFind('.') ? it->reverseFind('.') + 1 : "";
+		assetClass.toLower();
+		DEBUG_LOG(("DoCompressBenchmark - '%s', %d bytes\n", it->str(), origSize));
+
+		for (Int c = COMPRESSION_REFPACK; c <= COMPRESSION_HUFF; ++c)
+		{
+			CompressionType compType = (CompressionType)c;
+			for (Int b = 0; b < (Int)(sizeof(s_benchmarkBlockSizes)/sizeof(s_benchmarkBlockSizes[0])); ++b)
+			{
+				Int blockSize = s_benchmarkBlockSizes[b];
+				for (Int t = 0; t < (Int)(sizeof(s_benchmarkThreads)/sizeof(s_benchmarkThreads[0])); ++t)
+				{
+					Int numThreads = s_benchmarkThreads[t];
+					if (blockSize == 0 && numThreads > 1)
+						continue;	// a single block can't be split up
+
+					Int maxCompressedSize = blockSize ? CompressionManager::getMaxFramedCompressedSize(origSize, compType, blockSize) 
+						: CompressionManager::getMaxCompressedSize(origSize, compType);
+					UnsignedByte *compressedBuf = NEW UnsignedByte[maxCompressedSize];
+
+					Int compressedLen = 0;
+					Int decompressedLen = 0;
+					Int64 bestEncode = 0;
+					Int64 bestDecode = 0;
+					for (Int pass = 0; pass < BENCHMARK_PASSES; ++pass)
+					{
+						LARGE_INTEGER start, mid, end;
+						memset(uncompressedBuf, 0, origSize);
+
+						QueryPerformanceCounter(&start);
+						if (blockSize)
+							compressedLen = CompressionManager::compressDataFramed(compType, buf, origSize, compressedBuf, maxCompressedSize, blockSize, numThreads);
+						else
+							compressedLen = CompressionManager::compressData(compType, buf, origSize, compressedBuf, maxCompressedSize);
+						QueryPerformanceCounter(&mid);
+						decompressedLen = compressedLen ? CompressionManager::decompressData(compressedBuf, compressedLen, uncompressedBuf, origSize, numThreads) : 0;
+						QueryPerformanceCounter(&end);
+
+						Int64 encode = mid.QuadPart - start.QuadPart;
+						Int64 decode = end.QuadPart - mid.QuadPart;
+						if (pass == 0 || encode < bestEncode)
+							bestEncode = encode;
+						if (pass == 0 || decode < bestDecode)
+							bestDecode = decode;
+					}
+
+					// a failed round trip is a result too; it goes in the csv as roundTrip 0
+					Bool roundTrip = compressedLen && decompressedLen == origSize && memcmp(buf, uncompressedBuf, origSize) == 0;
+
+					fprintf(fp, "\"%s\",%s,%s,%d,%d,%d,%d,%g,%g,%g,%d\n", it->str(), assetClass.str(), CompressionManager::getCompressionNameByType(compType),
+						blockSize, numThreads, origSize, compressedLen, compressedLen / (Real)origSize,
+						getBenchmarkMBps(origSize, bestEncode, freq.QuadPart), getBenchmarkMBps(origSize, bestDecode, freq.QuadPart), roundTrip);
+
+					delete[] compressedBuf;
+					compressedBuf = NULL;
+				}
+			}
+		}
+
+		delete[] buf;
+		buf = NULL;
+
+		delete[] uncompressedBuf;
+		uncompressedBuf = NULL;
+	}
+
+	fclose(fp);
+	DEBUG_LOG(("DoCompressBenchmark - %d files, results in '%s'\n", (Int)files.size(), resultsFile));
+}
+
 #endif // TEST_COMPRESSION
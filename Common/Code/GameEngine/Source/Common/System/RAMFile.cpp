@@ -236,6 +236,35 @@ Bool RAMFile::openFromArchive(File *archiveFile, const AsciiString& filename, In
 	return TRUE;
 }
 
+//============================================================================
+// RAMFile::openFromBuffer
+//============================================================================
+/**
+	* Use a buffer somebody else already filled as the file's data.  The
+	* buffer belongs to us from here on and gets delete[]'d on close.  If
+	* this fails the buffer still belongs to the caller.
+	*/
+Bool RAMFile::openFromBuffer(Char *data, Int size, const AsciiString& filename)
+{
+	if (data == NULL) {
+		return FALSE;
+	}
+
+	if (File::open(filename.str(), File::READ | File::BINARY) == FALSE) {
+		return FALSE;
+	}
+
+	if (m_data != NULL) {
+		delete[] m_data;
+	}
+	m_data = data;
+	m_size = size;
+	m_pos = 0;
+	m_nameStr = filename;
+
+	return TRUE;
+}
+
 //=================================================================
 // RAMFile::close 	
 //=================================================================
@@ -107,7 +107,8 @@ StreamingArchiveFile::StreamingArchiveFile()
 : m_file(NULL), 
 	m_startingPos(0), 
 	m_size(0), 
-	m_curPos(0)
+	m_curPos(0),
+	m_archiveLock(NULL)
 {
 
 }
@@ -219,13 +220,16 @@ Int StreamingArchiveFile::read( void *buffer, Int bytes )
 		return 0;
 	}
 
+	if (bytes + m_curPos > m_size) 
+		bytes = m_size - m_curPos;
+
+	// another thread may be using the archive file, so keep its seeks out from between ours and the read.
+	ScopedCriticalSection lock(m_archiveLock);
+
 	// There shouldn't be a way that this can fail, because we've already verified that the file 
 	// contains at least this many bits.
 	m_file->seek(m_startingPos + m_curPos, File::START);
 
-	if (bytes + m_curPos > m_size) 
-		bytes = m_size - m_curPos;
-
 	Int bytesRead = m_file->read(buffer, bytes);
 
 	m_curPos += bytesRead;
@@ -36,6 +36,26 @@
 #include "Common/Snapshot.h"
 #include "winsock2.h" // for htonl
 
+// Uncomment to check every bulk CRC against the word at a time version using winsock's htonl.
+//#define VERIFY_BULK_XFER_CRC
+
+//-------------------------------------------------------------------------------------------------
+/** htonl, inline.  winsock's is a call into the dll, which we were making for every word we CRC.
+	* We only run on little endian machines, so it's always a byte swap. */
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt crcByteSwap( UnsignedInt val )
+{
+	return (val << 24) | ((val << 8) & 0x00ff0000) | ((val >> 8) & 0x0000ff00) | (val >> 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** One step of the CRC: rotate left a bit and add in the (already byte swapped) value */
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt crcStep( UnsignedInt crc, UnsignedInt val )
+{
+	return (crc << 1) + val + (crc >> 31);
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 XferCRC::XferCRC( void )
@@ -97,22 +117,8 @@ void XferCRC::endBlock( void )
 //-------------------------------------------------------------------------------------------------
 void XferCRC::addCRC( UnsignedInt val )
 {
-	int hibit;
-
-	val = htonl(val);
 
-	if (m_crc & 0x80000000)
-	{
-		hibit = 1;
-	}
-	else
-	{
-		hibit = 0;
-	}
-
-	m_crc <<= 1;
-	m_crc += val;
-	m_crc += hibit;
+	m_crc = crcStep( m_crc, crcByteSwap( val ) );
 
 }  // end addCRC
 
@@ -147,10 +153,37 @@ void XferCRC::xferImplementation( void *data, Int dataSize )
 
 	const UnsignedInt *uintPtr = (const UnsignedInt *) (data);
 
-	for (Int i=0 ; i<dataSize/4 ; i++)
+#ifdef VERIFY_BULK_XFER_CRC
+	UnsignedInt checkCRC = m_crc;
+	for (Int check=0 ; check<dataSize/4 ; check++)
 	{
-		addCRC (*uintPtr++);
+		UnsignedInt val = htonl(uintPtr[check]);
+		checkCRC = (checkCRC << 1) + val + ((checkCRC & 0x80000000) ? 1 : 0);
 	}
+#endif
+
+	// Keep the CRC in a register for the whole run of words, rather than going through addCRC 
+	// (and m_crc) for each one.  Each step depends on the one before, so this is as wide as it gets.
+	UnsignedInt crc = m_crc;
+	Int count = dataSize/4;
+	const UnsignedInt *end = uintPtr + count;
+	while (uintPtr + 4 <= end)
+	{
+		crc = crcStep( crc, crcByteSwap( uintPtr[0] ) );
+		crc = crcStep( crc, crcByteSwap( uintPtr[1] ) );
+		crc = crcStep( crc, crcByteSwap( uintPtr[2] ) );
+		crc = crcStep( crc, crcByteSwap( uintPtr[3] ) );
+		uintPtr += 4;
+	}
+	while (uintPtr < end)
+	{
+		crc = crcStep( crc, crcByteSwap( *uintPtr++ ) );
+	}
+	m_crc = crc;
+
+#ifdef VERIFY_BULK_XFER_CRC
+	DEBUG_ASSERTCRASH(checkCRC == m_crc, ("Bulk xfer CRC 0x%8.8X doesn't match 0x%8.8X\n", m_crc, checkCRC));
+#endif
 
 	int leftover = dataSize & 3;
 	if (leftover)
@@ -161,7 +194,7 @@ void XferCRC::xferImplementation( void *data, Int dataSize )
 		{
 			val += (c[i] << (i*8));
 		}
-		val = htonl(val);
+		val = crcByteSwap(val);
 		addCRC (val);
 	}
 	
@@ -179,7 +212,7 @@ void XferCRC::skip( Int dataSize )
 UnsignedInt XferCRC::getCRC( void )
 {
 
-	return htonl(m_crc);
+	return crcByteSwap(m_crc);
 
 }  // end skip
 
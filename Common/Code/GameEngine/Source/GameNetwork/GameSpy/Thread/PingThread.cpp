@@ -247,6 +247,8 @@ AsciiString Pinger::getPingString( Int timeout )
 
 void PingThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	try {
 #if 0
 	_set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
@@ -34,6 +34,7 @@
 #include "Common/ArchiveFile.h"
 #include "Common/AsciiString.h"
 #include "Common/List.h"
+#include "Common/CriticalSection.h"
 
 class Win32BIGFile : public ArchiveFile
 {
@@ -49,10 +50,15 @@ class Win32BIGFile : public ArchiveFile
 		virtual void					setSearchPriority( Int new_priority );	///< Set this BIG file's search priority
 		virtual void					close( void );													///< Close this BIG file
 
+		Bool									mapArchive( const Char *filename );			///< create a read-only file mapping of the whole BIG file for zero-copy opens
+		static void						logMappingStats( void );								///< dump the mapped view counters to the debug log
+
 	protected:
 
 		AsciiString		m_name;		///< BIG file name
 		AsciiString		m_path;		///< BIG file path
+		void					*m_mapping;	///< HANDLE of the read-only mapping of this BIG file, NULL if files get copied out through m_file instead
+		CriticalSection				m_fileLock;	///< keeps another thread's seek from landing between our seek and read on m_file
 };
 
 #endif // __WIN32BIGFILE_H
\ No newline at end of file
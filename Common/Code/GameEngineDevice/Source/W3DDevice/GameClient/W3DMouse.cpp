@@ -74,6 +74,8 @@ public:
 
 void MouseThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 
 	//poll mouse and update position
 
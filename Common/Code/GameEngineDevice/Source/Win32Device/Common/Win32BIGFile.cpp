@@ -34,11 +34,150 @@
 #include "Common/PerfTimer.h"
 #include "Win32Device/Common/Win32BIGFile.h"
 
+//============================================================================
+// mapped view counters
+//============================================================================
+// bumped from whichever thread opens the file, hence the Interlocked calls.
+// "pages" are the 4k pages covered by the views we handed out, which is the
+// most the mapping can have faulted in on our behalf.
+
+static volatile LONG s_archivesMapped = 0;		///< BIG files that got a mapping
+static volatile LONG s_mapFailures = 0;				///< BIG files that fell back to copying through m_file
+static volatile LONG s_viewsOpened = 0;				///< files handed out as mapped views
+static volatile LONG s_viewFailures = 0;			///< MapViewOfFile failures that fell back to a heap copy
+static volatile LONG s_pagesViewed = 0;				///< pages covered by all views ever handed out
+static volatile LONG s_liveViewKB = 0;				///< address space held by currently open views
+static volatile LONG s_peakViewKB = 0;				///< high water mark of s_liveViewKB
+
+static DWORD getMappingGranularity( void )
+{
+	static DWORD granularity = 0;
+	if (granularity == 0)
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		granularity = info.dwAllocationGranularity;
+	}
+	return granularity;
+}
+
+//============================================================================
+// MappedArchiveFile
+//============================================================================
+/**
+	* A read only RAMFile whose data points straight into a view of the BIG
+	* file's mapping rather than into a heap copy.  Only the window the file
+	* covers gets mapped, since mapping every BIG file whole would eat most of
+	* a 32 bit address space.  Each view has its own read position and never
+	* touches the shared archive File, so the texture loader thread can open
+	* and read files without serializing on m_file's seek.
+	*/
+class MappedArchiveFile : public RAMFile
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(MappedArchiveFile, "MappedArchiveFile")
+	protected:
+
+		void					*m_view;											///< base of the mapped view, m_data points somewhere inside it
+		Int						m_viewKB;											///< size of the view, for the counters
+
+	public:
+
+		MappedArchiveFile();
+		//virtual				~MappedArchiveFile();
+
+		Bool					openFromMapping(HANDLE mapping, const AsciiString& filename, Int offset, Int size); ///< point at the given range of the mapping instead of copying it
+		virtual void	close( void );																			///< Unmap the view and close the file
+		virtual char*	readEntireAndClose();																///< the view isn't ours to give away, so this one copies
+};
+
+MappedArchiveFile::MappedArchiveFile() :
+	m_view(NULL),
+	m_viewKB(0)
+{
+}
+
+MappedArchiveFile::~MappedArchiveFile()
+{
+	if (m_view != NULL)
+	{
+		UnmapViewOfFile(m_view);
+		m_view = NULL;
+		InterlockedExchangeAdd(&s_liveViewKB, -m_viewKB);
+	}
+	// keep RAMFile from delete[]ing memory it doesn't own.
+	m_data = NULL;
+}
+
+Bool MappedArchiveFile::openFromMapping(HANDLE mapping, const AsciiString& filename, Int offset, Int size)
+{
+	if (File::open(filename.str(), File::READ | File::BINARY) == FALSE) {
+		return FALSE;
+	}
+
+	// views have to start on an allocation granularity boundary, so map from the
+	// boundary just below the file and skip the lead-in.
+	DWORD viewOffset = (DWORD)offset & ~(getMappingGranularity() - 1);
+	DWORD leadIn = (DWORD)offset - viewOffset;
+	DWORD viewSize = leadIn + (DWORD)size;
+
+	m_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, viewOffset, viewSize);
+	if (m_view == NULL) {
+		InterlockedIncrement(&s_viewFailures);
+		return FALSE;
+	}
+
+	m_data = (Char *)m_view + leadIn;
+	m_size = size;
+	m_pos = 0;
+	m_nameStr = filename;
+
+	m_viewKB = (Int)((viewSize + 1023) / 1024);
+	InterlockedIncrement(&s_viewsOpened);
+	InterlockedExchangeAdd(&s_pagesViewed, (LONG)(((leadIn & 4095) + size + 4095) / 4096));
+	LONG liveKB = InterlockedExchangeAdd(&s_liveViewKB, m_viewKB) + m_viewKB;
+	LONG peakKB = s_peakViewKB;
+	while (liveKB > peakKB && InterlockedCompareExchange(&s_peakViewKB, liveKB, peakKB) != peakKB) {
+		peakKB = s_peakViewKB;
+	}
+
+	return TRUE;
+}
+
+void MappedArchiveFile::close( void )
+{
+	if (m_view != NULL)
+	{
+		UnmapViewOfFile(m_view);
+		m_view = NULL;
+		InterlockedExchangeAdd(&s_liveViewKB, -m_viewKB);
+	}
+	m_data = NULL;
+
+	RAMFile::close();
+}
+
+char* MappedArchiveFile::readEntireAndClose()
+{
+	if (m_data == NULL)
+	{
+		DEBUG_CRASH(("m_data is NULL in MappedArchiveFile::readEntireAndClose -- should not happen!\n"));
+		return NEW char[1];	// just to avoid crashing...
+	}
+
+	char* tmp = NEW char[m_size];
+	memcpy(tmp, m_data, m_size);
+
+	close();
+
+	return tmp;
+}
+
 //============================================================================
 // Win32BIGFile::Win32BIGFile
 //============================================================================
 
-Win32BIGFile::Win32BIGFile()
+Win32BIGFile::Win32BIGFile() :
+	m_mapping(NULL)
 {
 
 }
@@ -49,7 +188,56 @@ Win32BIGFile::Win32BIGFile()
 
 Win32BIGFile::~Win32BIGFile()
 {
+	// views still open keep the section alive on their own, so this is safe
+	// even if somebody is still holding on to one of our files.
+	if (m_mapping != NULL)
+	{
+		CloseHandle((HANDLE)m_mapping);
+		m_mapping = NULL;
+	}
+}
+
+//============================================================================
+// Win32BIGFile::mapArchive
+//============================================================================
+/**
+	* Create a read only mapping of the whole BIG file.  This only reserves the
+	* section, no address space is used until openFile maps a view.  If it fails
+	* openFile keeps copying files out through m_file like it always did.
+	*/
+Bool Win32BIGFile::mapArchive( const Char *filename )
+{
+	HANDLE file = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		InterlockedIncrement(&s_mapFailures);
+		return FALSE;
+	}
+
+	// the mapping holds its own reference to the file.
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
 
+	if (mapping == NULL) {
+		DEBUG_LOG(("Win32BIGFile::mapArchive - couldn't map %s, error %d, reading it through the file instead\n", filename, GetLastError()));
+		InterlockedIncrement(&s_mapFailures);
+		return FALSE;
+	}
+
+	m_mapping = mapping;
+	InterlockedIncrement(&s_archivesMapped);
+	return TRUE;
+}
+
+//============================================================================
+// Win32BIGFile::logMappingStats
+//============================================================================
+
+void Win32BIGFile::logMappingStats( void )
+{
+	DEBUG_LOG(("Win32BIGFile mapping stats: %d archives mapped, %d fell back to file reads\n", s_archivesMapped, s_mapFailures));
+	DEBUG_LOG(("Win32BIGFile mapping stats: %d views opened, %d view failures, %d pages viewed (%d KB)\n", 
+		s_viewsOpened, s_viewFailures, s_pagesViewed, s_pagesViewed * 4));
+	DEBUG_LOG(("Win32BIGFile mapping stats: %d KB in open views, peak %d KB\n", s_liveViewKB, s_peakViewKB));
 }
 
 //============================================================================
@@ -65,17 +253,45 @@ File* Win32BIGFile::openFile( const Char *filename, Int access )
 	}
 
 	RAMFile *ramFile = NULL;
-	
-	if (BitTestWW(access, File::STREAMING)) 
-		ramFile = newInstance( StreamingArchiveFile );
-	else 
-		ramFile = newInstance( RAMFile );
-
-	ramFile->deleteOnClose();
-	if (ramFile->openFromArchive(m_file, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size) == FALSE) {
-		ramFile->close();
-		ramFile = NULL;
-		return NULL;
+
+	if ((m_mapping != NULL) && (fileInfo->m_size > 0) && !BitTestWW(access, File::STREAMING))
+	{
+		// hand out a view straight into the mapping.  if windows won't give us one
+		// (address space gets tight late in a long game) fall back to the heap copy below.
+		MappedArchiveFile *mappedFile = newInstance( MappedArchiveFile );
+		mappedFile->deleteOnClose();
+		if (mappedFile->openFromMapping((HANDLE)m_mapping, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size)) {
+			ramFile = mappedFile;
+		} else {
+			mappedFile->close();
+		}
+	}
+
+	if (ramFile == NULL)
+	{
+		if (BitTestWW(access, File::STREAMING)) 
+			ramFile = newInstance( StreamingArchiveFile );
+		else 
+			ramFile = newInstance( RAMFile );
+
+		ramFile->deleteOnClose();
+
+		// files get opened from the prefetch and texture threads too, and they all share m_file.
+		// (streaming files keep seeking and reading m_file after this, so they get the lock too.)
+		Bool opened;
+		{
+			ScopedCriticalSection lock(&m_fileLock);
+			opened = ramFile->openFromArchive(m_file, fileInfo->m_filename, fileInfo->m_offset, fileInfo->m_size);
+		}
+		if (opened && BitTestWW(access, File::STREAMING)) {
+			((StreamingArchiveFile *)ramFile)->setArchiveLock(&m_fileLock);
+		}
+
+		if (opened == FALSE) {
+			ramFile->close();
+			ramFile = NULL;
+			return NULL;
+		}
 	}
 
 	if ((access & File::WRITE) == 0) {
@@ -47,18 +47,31 @@ enum CompressionType
 	COMPRESSION_HUFF,
 };
 
+enum
+{
+	COMPRESSION_DEFAULT_BLOCK_SIZE = 256 * 1024,	///< uncompressed bytes per block in the framed format
+	COMPRESSION_MAX_THREADS = 16
+};
+
+typedef Bool (*CompressionSink)( void *userData, const void *data, Int len );	///< write len bytes somewhere, FALSE on error
+typedef Int (*CompressionSource)( void *userData, void *data, Int len );			///< read up to len bytes, returns how many (0 at the end)
+
 class CompressionManager
 {
 public:
 
 	static Bool isDataCompressed( const void *mem, Int len );
-	static CompressionType getCompressionType( const void *mem, Int len );
+	static Bool isDataFramed( const void *mem, Int len );
+	static CompressionType getCompressionType( const void *mem, Int len );	///< for framed data, the codec its blocks use
 
 	static Int getMaxCompressedSize( Int uncompressedLen, CompressionType compType );
+	static Int getMaxFramedCompressedSize( Int uncompressedLen, CompressionType compType, Int blockSize = COMPRESSION_DEFAULT_BLOCK_SIZE );
 	static Int getUncompressedSize( const void *mem, Int len );
 
 	static Int compressData( CompressionType compType, void *src, Int srcLen, void *dest, Int destLen ); // 0 on error
-	static Int decompressData( void *src, Int srcLen, void *dest, Int destLen ); // 0 on error
+	static Int compressDataFramed( CompressionType compType, void *src, Int srcLen, void *dest, Int destLen, 
+		Int blockSize = COMPRESSION_DEFAULT_BLOCK_SIZE, Int numThreads = 1 ); // 0 on error
+	static Int decompressData( void *src, Int srcLen, void *dest, Int destLen, Int numThreads = 1 ); // 0 on error.  reads both formats, numThreads only helps framed data
 
 	static const char *getCompressionNameByType( CompressionType compType );
 
@@ -68,4 +81,82 @@ public:
 	static CompressionType getPreferredCompression( void );
 };
 
+// ---------------------------------------------------------------------------------------
+// The stream classes are library API only for now; nothing in the game reads or writes
+// framed streams yet.
+// ---------------------------------------------------------------------------------------
+/**
+	* Compresses a stream into the framed format one block at a time, so neither
+	* the whole input nor the whole output has to be in memory.  Each finished
+	* block goes straight to the sink.  The header can't know the final size, so
+	* readers work it out from the blocks.
+	*/
+class CompressionStreamWriter
+{
+public:
+	CompressionStreamWriter( CompressionType compType, CompressionSink sink, void *userData, Int blockSize = COMPRESSION_DEFAULT_BLOCK_SIZE );
+	~CompressionStreamWriter();
+
+	Bool write( const void *data, Int len );		///< FALSE if compression or the sink failed
+	Bool finish( void );												///< compress the last partial block.  call once, after the last write
+
+	Int getUncompressedLength( void ) const { return m_totalLen; }
+
+private:
+	Bool flushBlock( void );
+
+	CompressionType m_compType;
+	CompressionSink m_sink;
+	void *m_userData;
+	Int m_blockSize;
+	UnsignedByte *m_block;			///< input waiting to be compressed
+	Int m_blockLen;
+	UnsignedByte *m_packed;			///< one compressed block
+	Int m_packedSize;
+	Int m_totalLen;
+	Bool m_headerWritten;
+	Bool m_ok;
+};
+
+// ---------------------------------------------------------------------------------------
+/**
+	* Reads a stream written by CompressionStreamWriter or compressDataFramed a
+	* block at a time.  It also takes legacy single block data, which has to be
+	* read and decompressed in one go, and uncompressed data, which is passed
+	* straight through.
+	*/
+class CompressionStreamReader
+{
+public:
+	CompressionStreamReader( CompressionSource source, void *userData );
+	~CompressionStreamReader();
+
+	Int read( void *data, Int len );						///< returns bytes read, less than len only at the end or on error
+	Bool hadError( void ) const { return m_error; }
+
+private:
+	Bool start( void );
+	Bool nextBlock( void );
+	Int readSource( void *data, Int len );
+
+	CompressionSource m_source;
+	void *m_userData;
+	Bool m_started;
+	Bool m_framed;
+	Bool m_passThrough;					///< the data wasn't compressed at all
+	Bool m_error;
+	Int m_blockSize;
+	UnsignedByte *m_block;			///< current decompressed block
+	Int m_blockLen;
+	Int m_blockPos;
+	UnsignedByte *m_packed;
+	Int m_packedSize;
+	UnsignedByte m_header[8];		///< bytes peeked to identify the format, replayed when passing through
+	Int m_headerLen;
+	Int m_headerPos;
+	Int m_expectedLen;					///< total length from a framed header, or -1 if it was streamed
+	Int m_totalLen;							///< bytes decompressed so far
+	Int m_maxPackedLen;					///< worst case for one block, anything bigger is corrupt
+};
+
 #endif // __COMPRESSION_H__
@@ -31,6 +31,9 @@ extern "C" {
 #include "EAC/huffcodex.h"
 #include "EAC/refcodex.h"
 
+#include <windows.h>
+#include <process.h>
+
 #ifdef _INTERNAL
 // for occasional debugging...
 //#pragma optimize("", off)
@@ -39,12 +42,47 @@ extern "C" {
 
 #define DEBUG_LOG(x) {}
 
+// ---------------------------------------------------------------------------------------
+// Framed format:
+//   "EAF\0"
+//   Int total uncompressed length, or -1 if the writer was streaming and didn't know it
+//   Int block size (uncompressed bytes per block, only the last block may be shorter)
+//   Int compression type used by every block
+// then each block as an Int compressed length followed by an ordinary single block
+// buffer ("EAR\0" etc), which carries its own uncompressed length at offset 4.
+// ---------------------------------------------------------------------------------------
+
+enum
+{
+	FRAMED_HEADER_SIZE = 16,
+	FRAMED_BLOCK_HEADER_SIZE = 4,
+	FRAMED_MAX_BLOCK_SIZE = 64 * 1024 * 1024,		///< anything bigger is a corrupt header
+	FRAMED_UNKNOWN_LENGTH = -1
+};
+
+static Bool isBlockCodec( CompressionType compType )
+{
+	return compType > COMPRESSION_NONE && compType <= COMPRESSION_HUFF;
+}
+
+static Int readInt( const UnsignedByte *p )
+{
+	Int val;
+	memcpy(&val, p, sizeof(Int));
+	return val;
+}
+
+static void writeInt( UnsignedByte *p, Int val )
+{
+	memcpy(p, &val, sizeof(Int));
+}
+
 const char *CompressionManager::getCompressionNameByType( CompressionType compType )
 {
-	static const char *s_compressionNames[COMPRESSION_MAX+1] = {
+	// every type, not just up to COMPRESSION_MAX, so debug tools can name the unused codecs too
+	static const char *s_compressionNames[COMPRESSION_HUFF+1] = {
 		"No compression",
 		"RefPack",
-		/*
 		"LZHL",
 		"ZLib 1 (fast)",
 		"ZLib 2",
@@ -57,7 +95,6 @@ const char *CompressionManager::getCompressionNameByType( CompressionType compTy
 		"ZLib 9 (slow)",
 		"BTree",
 		"Huff",
-		*/
 	};
 	return s_compressionNames[compType];
 }
@@ -65,10 +102,9 @@ const char *CompressionManager::getCompressionNameByType( CompressionType compTy
 // For perf timers, so we can have separate ones for compression/decompression
 const char *CompressionManager::getDecompressionNameByType( CompressionType compType )
 {
-	static const char *s_decompressionNames[COMPRESSION_MAX+1] = {
+	static const char *s_decompressionNames[COMPRESSION_HUFF+1] = {
 		"d_None",
 		"d_RefPack",
-		/*
 		"d_NoxLZW",
 		"d_ZLib1",
 		"d_ZLib2",
@@ -81,7 +117,6 @@ const char *CompressionManager::getDecompressionNameByType( CompressionType comp
 		"d_ZLib9",
 		"d_BTree",
 		"d_Huff",
-		*/
 	};
 	return s_decompressionNames[compType];
 }
@@ -100,11 +135,22 @@ CompressionType CompressionManager::getPreferredCompression( void )
 }
 
 
+Bool CompressionManager::isDataFramed( const void *mem, Int len )
+{
+	return len >= FRAMED_HEADER_SIZE && memcmp( mem, "EAF\0", 4 ) == 0;
+}
+
 CompressionType CompressionManager::getCompressionType( const void *mem, Int len )
 {
 	if (len < 8)
 		return COMPRESSION_NONE;
 
+	if ( isDataFramed( mem, len ) )
+	{
+		CompressionType compType = (CompressionType)readInt( ((const UnsignedByte *)mem)+12 );
+		return isBlockCodec(compType) ? compType : COMPRESSION_NONE;
+	}
+
 	if ( memcmp( mem, "NOX\0", 4 ) == 0 )
 		return COMPRESSION_NOXLZH;
 
@@ -143,10 +189,21 @@ Int CompressionManager::getMaxCompressedSize( Int uncompressedLen, CompressionTy
 		case COMPRESSION_NOXLZH:
 			return (int)CalcNewSize(uncompressedLen) + 8;
 
-		case COMPRESSION_BTREE:   // guessing here
-		case COMPRESSION_HUFF:    // guessing here
-		case COMPRESSION_REFPACK: // guessing here
-			return uncompressedLen + 8;
+		// The EAC encoders don't take an output size, so these have to be real worst cases.
+		// RefPack: a 5-6 byte header, one control byte per 112 literals (a match never costs
+		// more than it covers) and the end of stream byte.
+		case COMPRESSION_REFPACK:
+			return uncompressedLen + uncompressedLen/112 + 8 + 8;
+
+		// Huff: the encoder clips codes to 16 bits, so a byte costs at most 2 bytes, plus up to
+		// 2 more for each escaped clue byte (the rarest byte, so at most len/256 of them) and
+		// the code table.
+		case COMPRESSION_HUFF:
+			return uncompressedLen*2 + uncompressedLen/128 + 2048 + 8;
+		// BTree: the encoder sizes its own work buffers at len*3/2 + 16K for the worst case;
+		// add the tree table and header on top.
+		case COMPRESSION_BTREE:
+			return uncompressedLen + uncompressedLen/2 + 16384 + 1024 + 8;
 
 		case COMPRESSION_ZLIB1:
 		case COMPRESSION_ZLIB2:
@@ -163,11 +220,45 @@ Int CompressionManager::getMaxCompressedSize( Int uncompressedLen, CompressionTy
 	return 0;
 }
 
+Int CompressionManager::getMaxFramedCompressedSize( Int uncompressedLen, CompressionType compType, Int blockSize )
+{
+	if (blockSize <= 0 || !isBlockCodec(compType))
+		return 0;
+
+	Int numFull = uncompressedLen / blockSize;
+	Int remainder = uncompressedLen % blockSize;
+	Int size = FRAMED_HEADER_SIZE + numFull * (FRAMED_BLOCK_HEADER_SIZE + getMaxCompressedSize(blockSize, compType));
+	if (remainder)
+		size += FRAMED_BLOCK_HEADER_SIZE + getMaxCompressedSize(remainder, compType);
+	return size;
+}
+
 Int CompressionManager::getUncompressedSize( const void *mem, Int len )
 {
 	if (len < 8)
 		return len;
 
+	if ( isDataFramed( mem, len ) )
+	{
+		const UnsignedByte *p = (const UnsignedByte *)mem;
+		Int total = readInt(p+4);
+		if (total != FRAMED_UNKNOWN_LENGTH)
+			return total;
+
+		// streamed data, so add up the blocks
+		total = 0;
+		Int pos = FRAMED_HEADER_SIZE;
+		while (pos + FRAMED_BLOCK_HEADER_SIZE + 8 <= len)
+		{
+			Int packedLen = readInt(p+pos);
+			if (packedLen < 8 || packedLen > len - pos - FRAMED_BLOCK_HEADER_SIZE)
+				break;
+			total += readInt(p+pos+FRAMED_BLOCK_HEADER_SIZE+4);
+			pos += FRAMED_BLOCK_HEADER_SIZE + packedLen;
+		}
+		return total;
+	}
+
 	CompressionType compType = getCompressionType( mem, len );
 	switch (compType)
 	{
@@ -200,6 +291,11 @@ Int CompressionManager::compressData( CompressionType compType, void *srcVoid, I
 	UnsignedByte *src = (UnsignedByte *)srcVoid;
 	UnsignedByte *dest = (UnsignedByte *)destVoid;
 
+	// the EAC encoders write as much as they need, so don't start one without room for its worst case
+	if ((compType == COMPRESSION_BTREE || compType == COMPRESSION_HUFF || compType == COMPRESSION_REFPACK) &&
+		destLen < getMaxCompressedSize(srcLen, compType) - 8)
+		return 0;
+
 	if (compType == COMPRESSION_BTREE)
 	{
 		memcpy(dest, "EAB\0", 4);
@@ -279,7 +375,9 @@ Int CompressionManager::compressData( CompressionType compType, void *srcVoid, I
 	return 0;
 }
 
-Int CompressionManager::decompressData( void *srcVoid, Int srcLen, void *destVoid, Int destLen )
+static Int decompressFramed( UnsignedByte *src, Int srcLen, UnsignedByte *dest, Int destLen, Int numThreads );
+
+Int CompressionManager::decompressData( void *srcVoid, Int srcLen, void *destVoid, Int destLen, Int numThreads )
 {
 	if (srcLen < 8)
 		return 0;
@@ -287,6 +385,9 @@ Int CompressionManager::decompressData( void *srcVoid, Int srcLen, void *destVoi
 	UnsignedByte *src = (UnsignedByte *)srcVoid;
 	UnsignedByte *dest = (UnsignedByte *)destVoid;
 
+	if (isDataFramed(src, srcLen))
+		return decompressFramed(src, srcLen, dest, destLen, numThreads);
+
 	CompressionType compType = getCompressionType(src, srcLen);
 
 	if (compType == COMPRESSION_BTREE)
@@ -348,6 +449,622 @@ Int CompressionManager::decompressData( void *srcVoid, Int srcLen, void *destVoi
 	return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+/////  Framed Compression  ////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+/// one block of a framed buffer, as laid out on both sides of the codec
+struct FramedBlock
+{
+	UnsignedByte *raw;
+	Int rawLen;
+	UnsignedByte *packed;
+	Int packedLen;			///< for compression, space available on the way in and bytes used on the way out
+};
+
+class FramedBlockJob;
+
+/**
+	* Worker threads for framed compression.  They're started the first time they're
+	* needed and then sleep between jobs, so a call doesn't pay for creating threads.
+	* One job runs at a time; if another thread wants the pool while it's busy, that
+	* caller just does its own job on its own.
+	*/
+class FramedThreadPool
+{
+public:
+	FramedThreadPool() : m_numThreads(0), m_job(NULL), m_busy(0), m_working(0), m_shutdown(FALSE)
+	{
+		m_wake = CreateSemaphore(NULL, 0, COMPRESSION_MAX_THREADS, NULL);
+		m_done = CreateEvent(NULL, FALSE, FALSE, NULL);
+	}
+
+	~FramedThreadPool()
+	{
+		if (m_numThreads)
+		{
+			m_shutdown = TRUE;
+			ReleaseSemaphore(m_wake, m_numThreads, NULL);
+			WaitForMultipleObjects(m_numThreads, m_threads, TRUE, INFINITE);
+			for (Int i = 0; i < m_numThreads; ++i)
+				CloseHandle(m_threads[i]);
+		}
+		if (m_wake)
+			CloseHandle(m_wake);
+		if (m_done)
+			CloseHandle(m_done);
+	}
+
+	/// how many helpers were put on the job; the caller must call finish() if it's nonzero
+	Int start( FramedBlockJob *job, Int numHelpers );
+	void finish( void );
+
+private:
+	static unsigned __stdcall threadProc( void *param );
+
+	HANDLE m_threads[COMPRESSION_MAX_THREADS];
+	Int m_numThreads;
+	HANDLE m_wake;							///< one count per helper wanted
+	HANDLE m_done;							///< set by the last helper out
+	FramedBlockJob * volatile m_job;
+	volatile LONG m_busy;
+	volatile LONG m_working;
+	volatile Bool m_shutdown;
+};
+
+static FramedThreadPool s_framedThreadPool;
+
+/**
+	* Runs the same job on every block, spread over the pool's worker threads.
+	* The calling thread works too, so numThreads includes it.  Blocks are handed out
+	* with an interlocked counter, so a slow block doesn't hold up the others.
+	*/
+class FramedBlockJob
+{
+public:
+	FramedBlockJob( FramedBlock *blocks, Int numBlocks, Bool compress, CompressionType compType ) :
+		m_blocks(blocks), m_numBlocks(numBlocks), m_compress(compress), m_compType(compType), m_next(0), m_failed(0)
+	{
+	}
+
+	Bool run( Int numThreads )
+	{
+		if (numThreads > COMPRESSION_MAX_THREADS)
+			numThreads = COMPRESSION_MAX_THREADS;
+		if (numThreads > m_numBlocks)
+			numThreads = m_numBlocks;
+		// the LZH library was never written with threads in mind, so leave it on this one
+		if (m_compType == COMPRESSION_NOXLZH)
+			numThreads = 1;
+
+		Int numHelpers = numThreads > 1 ? s_framedThreadPool.start(this, numThreads - 1) : 0;
+
+		work();
+
+		if (numHelpers)
+			s_framedThreadPool.finish();
+
+		return m_failed == 0;
+	}
+
+	void work( void )
+	{
+		for (;;)
+		{
+			Int i = InterlockedIncrement(&m_next) - 1;
+			if (i >= m_numBlocks || m_failed)
+				return;
+			if (!doBlock(m_blocks[i]))
+				InterlockedExchange(&m_failed, 1);
+		}
+	}
+
+private:
+	Bool doBlock( FramedBlock& block )
+	{
+		if (m_compress)
+		{
+			block.packedLen = CompressionManager::compressData(m_compType, block.raw, block.rawLen, block.packed, block.packedLen);
+			return block.packedLen != 0;
+		}
+
+		// a framed block inside a framed block would only be a corrupt or hostile file
+		if (CompressionManager::isDataFramed(block.packed, block.packedLen))
+			return FALSE;
+		return CompressionManager::decompressData(block.packed, block.packedLen, block.raw, block.rawLen) == block.rawLen;
+	}
+
+	FramedBlock *m_blocks;
+	Int m_numBlocks;
+	Bool m_compress;
+	CompressionType m_compType;
+	volatile LONG m_next;
+	volatile LONG m_failed;
+};
+
+Int FramedThreadPool::start( FramedBlockJob *job, Int numHelpers )
+{
+	if (!m_wake || !m_done || InterlockedExchange(&m_busy, 1))
+		return 0;	// someone else has the pool, so do it all ourselves
+
+	while (m_numThreads < numHelpers && m_numThreads < COMPRESSION_MAX_THREADS - 1)
+	{
+		unsigned threadID;
+		HANDLE h = (HANDLE)_beginthreadex(NULL, 0, threadProc, this, 0, &threadID);
+		if (!h)
+			break;	// just do more of it ourselves
+		m_threads[m_numThreads++] = h;
+	}
+	if (numHelpers > m_numThreads)
+		numHelpers = m_numThreads;
+	if (numHelpers == 0)
+	{
+		InterlockedExchange(&m_busy, 0);
+		return 0;
+	}
+
+	m_job = job;
+	m_working = numHelpers;
+	ReleaseSemaphore(m_wake, numHelpers, NULL);
+	return numHelpers;
+}
+
+void FramedThreadPool::finish( void )
+{
+	WaitForSingleObject(m_done, INFINITE);
+	m_job = NULL;
+	InterlockedExchange(&m_busy, 0);
+}
+
+unsigned __stdcall FramedThreadPool::threadProc( void *param )
+{
+	FramedThreadPool *pool = (FramedThreadPool *)param;
+	for (;;)
+	{
+		WaitForSingleObject(pool->m_wake, INFINITE);
+		if (pool->m_shutdown)
+			return 0;
+		pool->m_job->work();
+		if (InterlockedDecrement(&pool->m_working) == 0)
+			SetEvent(pool->m_done);
+	}
+}
+
+Int CompressionManager::compressDataFramed( CompressionType compType, void *srcVoid, Int srcLen, void *destVoid, Int destLen, Int blockSize, Int numThreads )
+{
+	if (!isBlockCodec(compType) || blockSize <= 0 || srcLen < 0 || destLen < FRAMED_HEADER_SIZE)
+		return 0;
+
+	UnsignedByte *src = (UnsignedByte *)srcVoid;
+	UnsignedByte *dest = (UnsignedByte *)destVoid;
+
+	memcpy(dest, "EAF\0", 4);
+	writeInt(dest+4, srcLen);
+	writeInt(dest+8, blockSize);
+	writeInt(dest+12, compType);
+
+	Int numBlocks = (srcLen + blockSize - 1) / blockSize;
+	if (numBlocks == 0)
+		return FRAMED_HEADER_SIZE;
+
+	FramedBlock *blocks = new FramedBlock[numBlocks];
+	UnsignedByte *scratch = NULL;
+	Int i;
+
+	if (numThreads > 1 && numBlocks > 1)
+	{
+		// each block gets its own worst case space, and they're packed together afterwards
+		Int maxPacked = getMaxCompressedSize(blockSize, compType);
+		scratch = new UnsignedByte[numBlocks * maxPacked];
+		for (i = 0; i < numBlocks; ++i)
+		{
+			blocks[i].raw = src + i * blockSize;
+			blocks[i].rawLen = min(blockSize, srcLen - i * blockSize);
+			blocks[i].packed = scratch + i * maxPacked;
+			blocks[i].packedLen = maxPacked;
+		}
+
+		FramedBlockJob job(blocks, numBlocks, TRUE, compType);
+		Bool ok = job.run(numThreads);
+
+		Int pos = FRAMED_HEADER_SIZE;
+		for (i = 0; ok && i < numBlocks; ++i)
+		{
+			if (pos + FRAMED_BLOCK_HEADER_SIZE + blocks[i].packedLen > destLen)
+			{
+				ok = FALSE;
+				break;
+			}
+			writeInt(dest+pos, blocks[i].packedLen);
+			memcpy(dest+pos+FRAMED_BLOCK_HEADER_SIZE, blocks[i].packed, blocks[i].packedLen);
+			pos += FRAMED_BLOCK_HEADER_SIZE + blocks[i].packedLen;
+		}
+
+		delete[] scratch;
+		delete[] blocks;
+		return ok ? pos : 0;
+	}
+
+	// one thread, so compress straight into place
+	Int pos = FRAMED_HEADER_SIZE;
+	for (i = 0; i < numBlocks; ++i)
+	{
+		Int rawLen = min(blockSize, srcLen - i * blockSize);
+		Int room = destLen - pos - FRAMED_BLOCK_HEADER_SIZE;
+		if (room < getMaxCompressedSize(rawLen, compType))
+		{
+			pos = 0;
+			break;
+		}
+		Int packedLen = compressData(compType, src + i * blockSize, rawLen, dest+pos+FRAMED_BLOCK_HEADER_SIZE, room);
+		if (!packedLen)
+		{
+			pos = 0;
+			break;
+		}
+		writeInt(dest+pos, packedLen);
+		pos += FRAMED_BLOCK_HEADER_SIZE + packedLen;
+	}
+
+	delete[] blocks;
+	return pos;
+}
+
+static Int decompressFramed( UnsignedByte *src, Int srcLen, UnsignedByte *dest, Int destLen, Int numThreads )
+{
+	Int blockSize = readInt(src+8);
+	CompressionType compType = (CompressionType)readInt(src+12);
+	if (blockSize <= 0 || blockSize > FRAMED_MAX_BLOCK_SIZE || !isBlockCodec(compType))
+		return 0;
+
+	// count the blocks first so the threads can each be handed a complete description
+	Int numBlocks = 0;
+	Int pos = FRAMED_HEADER_SIZE;
+	while (pos < srcLen)
+	{
+		if (pos + FRAMED_BLOCK_HEADER_SIZE > srcLen)
+			return 0;
+		Int packedLen = readInt(src+pos);
+		if (packedLen < 8 || packedLen > srcLen - pos - FRAMED_BLOCK_HEADER_SIZE)
+			return 0;
+		pos += FRAMED_BLOCK_HEADER_SIZE + packedLen;
+		++numBlocks;
+	}
+	if (numBlocks == 0)
+		return 0;
+
+	FramedBlock *blocks = new FramedBlock[numBlocks];
+	Int outPos = 0;
+	pos = FRAMED_HEADER_SIZE;
+	for (Int i = 0; i < numBlocks; ++i)
+	{
+		Int packedLen = readInt(src+pos);
+		Int rawLen = readInt(src+pos+FRAMED_BLOCK_HEADER_SIZE+4);
+		if (rawLen <= 0 || rawLen > blockSize || rawLen > destLen - outPos)
+		{
+			delete[] blocks;
+			return 0;
+		}
+		blocks[i].packed = src+pos+FRAMED_BLOCK_HEADER_SIZE;
+		blocks[i].packedLen = packedLen;
+		blocks[i].raw = dest+outPos;
+		blocks[i].rawLen = rawLen;
+		pos += FRAMED_BLOCK_HEADER_SIZE + packedLen;
+		outPos += rawLen;
+	}
+
+	// getUncompressedSize() believes the header, so it had better agree with the blocks
+	Int totalLen = readInt(src+4);
+	if (totalLen != FRAMED_UNKNOWN_LENGTH && totalLen != outPos)
+	{
+		delete[] blocks;
+		return 0;
+	}
+
+	FramedBlockJob job(blocks, numBlocks, FALSE, compType);
+	Bool ok = job.run(max(numThreads, 1));
+
+	delete[] blocks;
+	return ok ? outPos : 0;
+}
+
+// ---------------------------------------------------------------------------------------
+
+CompressionStreamWriter::CompressionStreamWriter( CompressionType compType, CompressionSink sink, void *userData, Int blockSize ) :
+	m_compType(compType),
+	m_sink(sink),
+	m_userData(userData),
+	m_blockSize(blockSize),
+	m_block(NULL),
+	m_blockLen(0),
+	m_packed(NULL),
+	m_packedSize(0),
+	m_totalLen(0),
+	m_headerWritten(FALSE),
+	m_ok(FALSE)
+{
+	if (sink && blockSize > 0 && blockSize <= FRAMED_MAX_BLOCK_SIZE && isBlockCodec(compType))
+	{
+		m_packedSize = CompressionManager::getMaxCompressedSize(blockSize, compType);
+		m_block = new UnsignedByte[blockSize];
+		m_packed = new UnsignedByte[FRAMED_BLOCK_HEADER_SIZE + m_packedSize];
+		m_ok = TRUE;
+	}
+}
+
+CompressionStreamWriter::~CompressionStreamWriter()
+{
+	delete[] m_block;
+	delete[] m_packed;
+}
+
+Bool CompressionStreamWriter::write( const void *data, Int len )
+{
+	if (!m_ok)
+		return FALSE;
+
+	if (!m_headerWritten)
+	{
+		UnsignedByte header[FRAMED_HEADER_SIZE];
+		memcpy(header, "EAF\0", 4);
+		writeInt(header+4, FRAMED_UNKNOWN_LENGTH);
+		writeInt(header+8, m_blockSize);
+		writeInt(header+12, m_compType);
+		m_headerWritten = TRUE;
+		if (!m_sink(m_userData, header, FRAMED_HEADER_SIZE))
+		{
+			m_ok = FALSE;
+			return FALSE;
+		}
+	}
+
+	const UnsignedByte *p = (const UnsignedByte *)data;
+	while (len > 0)
+	{
+		Int chunk = min(len, m_blockSize - m_blockLen);
+		memcpy(m_block + m_blockLen, p, chunk);
+		m_blockLen += chunk;
+		m_totalLen += chunk;
+		p += chunk;
+		len -= chunk;
+
+		if (m_blockLen == m_blockSize && !flushBlock())
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+Bool CompressionStreamWriter::finish( void )
+{
+	// an empty stream still gets a header, so readers know what it is
+	if (!write(NULL, 0))
+		return FALSE;
+	return m_blockLen == 0 || flushBlock();
+}
+
+Bool CompressionStreamWriter::flushBlock( void )
+{
+	Int packedLen = CompressionManager::compressData(m_compType, m_block, m_blockLen, m_packed + FRAMED_BLOCK_HEADER_SIZE, m_packedSize);
+	m_blockLen = 0;
+	if (!packedLen)
+	{
+		m_ok = FALSE;
+		return FALSE;
+	}
+
+	writeInt(m_packed, packedLen);
+	if (!m_sink(m_userData, m_packed, FRAMED_BLOCK_HEADER_SIZE + packedLen))
+		m_ok = FALSE;
+	return m_ok;
+}
+
+// ---------------------------------------------------------------------------------------
+
+CompressionStreamReader::CompressionStreamReader( CompressionSource source, void *userData ) :
+	m_source(source),
+	m_userData(userData),
+	m_started(FALSE),
+	m_framed(FALSE),
+	m_passThrough(FALSE),
+	m_error(FALSE),
+	m_blockSize(0),
+	m_block(NULL),
+	m_blockLen(0),
+	m_blockPos(0),
+	m_packed(NULL),
+	m_packedSize(0),
+	m_headerLen(0),
+	m_headerPos(0),
+	m_expectedLen(FRAMED_UNKNOWN_LENGTH),
+	m_totalLen(0),
+	m_maxPackedLen(0)
+{
+}
+
+CompressionStreamReader::~CompressionStreamReader()
+{
+	delete[] m_block;
+	delete[] m_packed;
+}
+
+Int CompressionStreamReader::readSource( void *data, Int len )
+{
+	UnsignedByte *p = (UnsignedByte *)data;
+	Int total = 0;
+	while (total < len)
+	{
+		Int got = m_source(m_userData, p + total, len - total);
+		if (got <= 0)
+			break;
+		total += got;
+	}
+	return total;
+}
+
+Bool CompressionStreamReader::start( void )
+{
+	m_started = TRUE;
+	if (!m_source)
+	{
+		m_error = TRUE;
+		return FALSE;
+	}
+
+	m_headerLen = readSource(m_header, 8);
+	if (m_headerLen == 8 && memcmp(m_header, "EAF\0", 4) == 0)
+	{
+		UnsignedByte rest[FRAMED_HEADER_SIZE - 8];
+		if (readSource(rest, sizeof(rest)) != sizeof(rest))
+		{
+			m_error = TRUE;
+			return FALSE;
+		}
+		m_blockSize = readInt(rest);
+		CompressionType compType = (CompressionType)readInt(rest+4);
+		if (m_blockSize <= 0 || m_blockSize > FRAMED_MAX_BLOCK_SIZE || !isBlockCodec(compType))
+		{
+			m_error = TRUE;
+			return FALSE;
+		}
+		m_expectedLen = readInt(m_header+4);
+		m_maxPackedLen = CompressionManager::getMaxCompressedSize(m_blockSize, compType);
+		m_framed = TRUE;
+		m_block = new UnsignedByte[m_blockSize];
+		return TRUE;
+	}
+
+	if (!CompressionManager::isDataCompressed(m_header, m_headerLen))
+	{
+		m_passThrough = TRUE;
+		return TRUE;
+	}
+
+	// the old single block formats can only be decompressed in one go, so slurp it all
+	Int packedLen = m_headerLen;
+	m_packedSize = 64 * 1024;
+	m_packed = new UnsignedByte[m_packedSize];
+	memcpy(m_packed, m_header, m_headerLen);
+	for (;;)
+	{
+		if (packedLen == m_packedSize)
+		{
+			UnsignedByte *bigger = new UnsignedByte[m_packedSize * 2];
+			memcpy(bigger, m_packed, packedLen);
+			delete[] m_packed;
+			m_packed = bigger;
+			m_packedSize *= 2;
+		}
+		Int got = readSource(m_packed + packedLen, m_packedSize - packedLen);
+		if (got <= 0)
+			break;
+		packedLen += got;
+	}
+
+	Int rawLen = CompressionManager::getUncompressedSize(m_packed, packedLen);
+	if (rawLen < 0)
+	{
+		m_error = TRUE;
+		return FALSE;
+	}
+	m_block = new UnsignedByte[max(rawLen, 1)];
+	m_blockLen = CompressionManager::decompressData(m_packed, packedLen, m_block, rawLen);
+	if (m_blockLen != rawLen)
+	{
+		m_blockLen = 0;
+		m_error = TRUE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+Bool CompressionStreamReader::nextBlock( void )
+{
+	UnsignedByte lenBuf[FRAMED_BLOCK_HEADER_SIZE];
+	Int got = readSource(lenBuf, FRAMED_BLOCK_HEADER_SIZE);
+	if (got == 0)
+	{
+		// clean end of stream, as long as it's as long as the header said
+		if (m_expectedLen != FRAMED_UNKNOWN_LENGTH && m_expectedLen != m_totalLen)
+			m_error = TRUE;
+		return FALSE;
+	}
+
+	Int packedLen = got == FRAMED_BLOCK_HEADER_SIZE ? readInt(lenBuf) : 0;
+	if (packedLen < 8 || packedLen > m_maxPackedLen)
+	{
+		m_error = TRUE;
+		return FALSE;
+	}
+
+	if (packedLen > m_packedSize)
+	{
+		delete[] m_packed;
+		m_packedSize = packedLen;
+		m_packed = new UnsignedByte[m_packedSize];
+	}
+
+	Int rawLen = 0;
+	if (readSource(m_packed, packedLen) == packedLen && !CompressionManager::isDataFramed(m_packed, packedLen))
+	{
+		rawLen = readInt(m_packed+4);
+		if (rawLen > 0 && rawLen <= m_blockSize)
+			m_blockLen = CompressionManager::decompressData(m_packed, packedLen, m_block, rawLen);
+	}
+
+	m_blockPos = 0;
+	if (rawLen <= 0 || m_blockLen != rawLen)
+	{
+		m_blockLen = 0;
+		m_error = TRUE;
+		return FALSE;
+	}
+	m_totalLen += rawLen;
+	if (m_expectedLen != FRAMED_UNKNOWN_LENGTH && m_totalLen > m_expectedLen)
+	{
+		m_blockLen = 0;
+		m_error = TRUE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+Int CompressionStreamReader::read( void *data, Int len )
+{
+	if (!m_started && !start())
+		return 0;
+	if (m_error)
+		return 0;
+
+	UnsignedByte *p = (UnsignedByte *)data;
+	Int total = 0;
+
+	if (m_passThrough)
+	{
+		Int chunk = min(len, m_headerLen - m_headerPos);
+		memcpy(p, m_header + m_headerPos, chunk);
+		m_headerPos += chunk;
+		return chunk + readSource(p + chunk, len - chunk);
+	}
+
+	while (total < len)
+	{
+		if (m_blockPos == m_blockLen)
+		{
+			if (!m_framed || !nextBlock())
+				break;
+		}
+		Int chunk = min(len - total, m_blockLen - m_blockPos);
+		memcpy(p + total, m_block + m_blockPos, chunk);
+		m_blockPos += chunk;
+		total += chunk;
+	}
+
+	return total;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 /////  Performance Testing  ///////////////////////////////////////////////////////////////
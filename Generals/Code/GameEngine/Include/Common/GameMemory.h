@@ -829,6 +829,17 @@ extern Bool isMemoryManagerOfficiallyInited();
 */
 extern void shutdownMemoryManager();
 
+/**
+	MemoryPools here don't keep per-thread caches, so there's nothing for a thread to release.
+	This only exists so that thread code shared with Zero Hour compiles.
+*/
+class ScopedThreadMemoryPoolCaches
+{
+public:
+	ScopedThreadMemoryPoolCaches() { }
+	~ScopedThreadMemoryPoolCaches() { }
+};
+
 extern MemoryPoolFactory *TheMemoryPoolFactory;
 extern DynamicMemoryAllocator *TheDynamicMemoryAllocator;
 
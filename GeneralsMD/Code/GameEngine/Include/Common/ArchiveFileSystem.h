@@ -80,31 +80,13 @@ class ArchiveFile;
 	* openFile() member searches all Archive files for the specified sub file.
 	*/
 //===============================
-class ArchivedDirectoryInfo;
 class DetailedArchivedDirectoryInfo;
 class ArchivedFileInfo;
 
 typedef std::map<AsciiString, DetailedArchivedDirectoryInfo> DetailedArchivedDirectoryInfoMap;
-typedef std::map<AsciiString, ArchivedDirectoryInfo> ArchivedDirectoryInfoMap;
 typedef std::map<AsciiString, ArchivedFileInfo> ArchivedFileInfoMap;
 typedef std::map<AsciiString, ArchiveFile *> ArchiveFileMap;
-typedef std::map<AsciiString, AsciiString> ArchivedFileLocationMap; // first string is the file name, second one is the archive filename.
-
-class ArchivedDirectoryInfo 
-{
-public:
-	AsciiString								m_directoryName;
-	ArchivedDirectoryInfoMap	m_directories;
-	ArchivedFileLocationMap		m_files;
-
-	void clear()
-	{
-		m_directoryName.clear();
-		m_directories.clear();
-		m_files.clear();
-	}
-
-};
+typedef std::unordered_map<AsciiString, AsciiString, rts::hash<AsciiString>, rts::equal_to<AsciiString> > ArchivedFileLocationMap; // first string is the lookup key (see ArchiveFile::makeLookupKey), second one is the archive filename.
 
 class DetailedArchivedDirectoryInfo 
 {
@@ -178,7 +160,7 @@ protected:
 	virtual void					loadIntoDirectoryTree(const ArchiveFile *archiveFile, const AsciiString& archiveFilename, Bool overwrite = FALSE );	///< load the archive file's header information and apply it to the global archive directory tree.
 
 	ArchiveFileMap m_archiveFileMap;
-	ArchivedDirectoryInfo m_rootDirectory;
+	ArchivedFileLocationMap m_fileLocations;	///< which archive each file comes out of, keyed by ArchiveFile::makeLookupKey
 };
 
 
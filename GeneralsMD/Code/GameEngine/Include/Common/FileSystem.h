@@ -58,6 +58,7 @@
 //           Forward References
 //----------------------------------------------------------------------------
 class File;
+class FilePrefetcher;
 
 //----------------------------------------------------------------------------
 //           Type Defines
@@ -65,6 +66,7 @@ class File;
 
 typedef std::set<AsciiString, rts::less_than_nocase<AsciiString> > FilenameList;
 typedef FilenameList::iterator FilenameListIter;
+typedef std::vector<AsciiString> PrefetchFileList;
 
 //----------------------------------------------------------------------------
 //           Type Defines
@@ -141,8 +143,14 @@ public:
 	Bool areMusicFilesOnCD();
 	void loadMusicFilesFromCD();
 	void unloadMusicFilesFromCD();
+
+	void prefetchFiles( const PrefetchFileList& filenames, Bool decompress = FALSE );	///< read these archived files on worker threads so the open that follows finds them in memory.  decompress also unpacks compressed data for takePrefetchedData.
+	void flushPrefetches( void );																						///< stop prefetching and free anything that was prefetched but never opened
+	Bool takePrefetchedData( const Char *filename, Bool decompressed, char *&data, Int &size );	///< hand over a prefetched buffer (caller delete[]s it).  decompressed says the caller can take unpacked data.
+
 protected:
   mutable std::map<unsigned,bool> m_fileExist;
+	FilePrefetcher *m_prefetcher;		///< created by the first prefetchFiles call
 };
 
 extern FileSystem*	TheFileSystem;
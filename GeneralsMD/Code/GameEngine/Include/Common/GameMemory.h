@@ -60,6 +60,13 @@
 	#define MEMORYPOOL_DEBUG
 #endif
 
+// by default, give each thread a small cache ("magazine") of free blocks for each pool, so that
+// most allocations and frees don't need TheMemoryPoolCriticalSection. not used in MEMORYPOOL_DEBUG
+// builds, since the per-block bookkeeping there needs the lock anyway.
+#if !defined(MEMORYPOOL_DEBUG) && !defined(MEMORYPOOL_MAGAZINES) && !defined(DISABLE_MEMORYPOOL_MAGAZINES)
+	#define MEMORYPOOL_MAGAZINES
+#endif
+
 // SYSTEM INCLUDES ////////////////////////////////////////////////////////////
 
 #include <new.h>
@@ -213,6 +220,7 @@ class MemoryPool;
 class MemoryPoolFactory;
 class DynamicMemoryAllocator;
 class BlockCheckpointInfo;
+struct MemoryPoolMagazine;
 
 // TYPE DEFINES ///////////////////////////////////////////////////////////////
 
@@ -295,7 +303,11 @@ private:
 	Int								m_peakUsedBlocksInPool;			///< high-water mark of m_usedBlocksInPool
 	MemoryPoolBlob		*m_firstBlob;								///< head of linked list: first blob for this pool.
 	MemoryPoolBlob		*m_lastBlob;								///< tail of linked list: last blob for this pool. (needed for efficiency)
-	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< first blob in this pool that has at least one unallocated block.
+	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< head of linked list: blobs in this pool that have at least one unallocated block.
+#ifdef MEMORYPOOL_MAGAZINES
+	Int								m_magazineSlot;							///< index of this pool in each thread's magazine table (-1 == no magazines)
+	UnsignedInt				m_magazineGeneration;				///< bumped by reset(); magazines filled before that are discarded
+#endif
 
 private:
 	/// create a new blob with the given number of blocks.
@@ -304,6 +316,23 @@ private:
 	/// destroy a blob.
 	Int freeBlob(MemoryPoolBlob *blob);
 
+	/// take a block from the blobs, creating an overflow blob if necessary. (caller must hold TheMemoryPoolCriticalSection)
+	MemoryPoolSingleBlock *takeBlockFromBlobs(DECLARE_LITERALSTRING_ARG1);
+
+	/// give a block back to its blob. (caller must hold TheMemoryPoolCriticalSection)
+	void returnBlockToBlob(MemoryPoolSingleBlock *block);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	/// return the calling thread's magazine for this pool, or null if this pool doesn't use them.
+	MemoryPoolMagazine *getThreadMagazine();
+
+	/// move a batch of blocks from the blobs into the magazine. (will throw on failure)
+	void refillMagazine(MemoryPoolMagazine *mag);
+
+	/// give the oldest 'count' blocks in the magazine back to their blobs.
+	void spillMagazine(MemoryPoolMagazine *mag, Int count);
+#endif
+
 public:
 
 	// 'public' funcs that are really only for use by MemoryPoolFactory
@@ -350,7 +379,7 @@ public:
 	/// return the number of free (available) blocks in this pool.
 	Int getFreeBlockCount();
 
-	/// return the number of blocks in use in this pool.
+	/// return the number of blocks in use in this pool. (this includes blocks cached in thread magazines)
 	Int getUsedBlockCount();
 
 	/// return the total number of blocks in this pool. [ == getFreeBlockCount() + getUsedBlockCount() ]
@@ -367,6 +396,9 @@ public:
 	/// if this pool has any empty blobs, return them to the system.
 	Int releaseEmpties();
 
+	/// give the calling thread's cached blocks for this pool back to the pool.
+	void releaseThreadMagazine();
+
 	/// destroy all blocks and blobs in this pool.
 	void reset();
 
@@ -396,6 +428,8 @@ private:
 	Int												m_usedBlocksInDma = 0;		///< total number of blocks allocated, from subpools and "raw"
 	MemoryPool* m_pools[MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS] = {};	///< the subpools
 	MemoryPoolSingleBlock			*m_rawBlocks = 0;					///< linked list of "raw" blocks allocated directly from system
+	MemoryPool								**m_poolForSizeClass = 0;	///< best subpool for each size, in MEM_BOUND_ALIGNMENT steps, up to m_largestPoolSize
+	Int												m_largestPoolSize = -1;		///< allocation size of the largest subpool (-1 if none)
 
 	/// return the best pool for the given allocSize, or null if none are suitable
 	MemoryPool *findPoolForSize(Int allocSize);
@@ -482,6 +516,7 @@ class MemoryPoolFactory
 private:
 	MemoryPool								*m_firstPoolInFactory;		///< linked list of pools
 	DynamicMemoryAllocator		*m_firstDmaInFactory;			///< linked list of dmas
+	Bool											m_releaseEmptyOverflowBlobs;	///< if true, pools give overflow blobs back to the system as soon as they are empty
 #ifdef MEMORYPOOL_CHECKPOINTING
 	Int												m_curCheckpoint;					///< most recent checkpoint value
 #endif
@@ -508,12 +543,22 @@ public:
 		Int getCurCheckpoint() { return m_curCheckpoint; }
 	#endif
 
+	/// return true iff pools should free their overflow blobs as soon as they are empty.
+	Bool getReleaseEmptyOverflowBlobs() const { return m_releaseEmptyOverflowBlobs; }
+
 public:
 	
 	MemoryPoolFactory();
 	void init();
 	~MemoryPoolFactory();
 
+	/**
+		if enabled, pools give each overflow blob back to the system as soon as its last block 
+		is freed, instead of keeping it around for reuse. this caps memory use after a spike 
+		(eg, a big battle), at the cost of reallocating the blobs if the spike recurs.
+	*/
+	void setReleaseEmptyOverflowBlobs(Bool enable) { m_releaseEmptyOverflowBlobs = enable; }
+
 	/// create a new memory pool with the given settings. if a pool with the given name already exists, return it.
 	MemoryPool *createMemoryPool(const PoolInitRec *parms);
 
@@ -829,6 +874,24 @@ extern Bool isMemoryManagerOfficiallyInited();
 */
 extern void shutdownMemoryManager();
 
+/**
+	Give all of the calling thread's cached pool blocks back to their pools, and free the
+	thread's cache. Threads other than the main thread that allocate from MemoryPools should
+	call this before they exit, or their cached blocks will stay in use forever.
+*/
+extern void releaseThreadMemoryPoolCaches();
+
+/**
+	Put one of these at the top of a thread function, and releaseThreadMemoryPoolCaches()
+	gets called however the function exits.
+*/
+class ScopedThreadMemoryPoolCaches
+{
+public:
+	ScopedThreadMemoryPoolCaches() { }
+	~ScopedThreadMemoryPoolCaches() { releaseThreadMemoryPoolCaches(); }
+};
+
 extern MemoryPoolFactory *TheMemoryPoolFactory;
 extern DynamicMemoryAllocator *TheDynamicMemoryAllocator;
 
@@ -254,6 +254,7 @@ public:
 	Bool m_debugAIObstacles;			///< Used to display AI obstacle debug information
 	Bool m_showObjectHealth;			///< debug display object health
 	Bool m_scriptDebug;						///< Should we attempt to load the script debugger window (.DLL)
+	Bool m_profileScripts;				///< Should the script engine time scripts and write a report at map end?
 	Bool m_particleEdit;					///< Should we attempt to load the particle editor (.DLL)
 	Bool m_displayDebug;					///< Used to display display debug info
 	Bool m_winCursors;						///< Should we force use of windows cursors?
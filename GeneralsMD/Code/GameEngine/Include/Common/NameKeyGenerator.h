@@ -38,6 +38,8 @@
 #include "Common/GameMemory.h"
 #include "Common/AsciiString.h"
 
+#include <vector>
+
 //------------------------------------------------------------------------------------------------- 
 /**
 	Note that NameKeyType isn't a "real" enum, but an enum type used to enforce the
@@ -53,6 +55,20 @@ enum NameKeyType
 	FORCE_NAMEKEYTYPE_LONG	= 0x7fffffff	// a trick to ensure the NameKeyType is a 32-bit int
 };
 
+//-------------------------------------------------------------------------------------------------
+/** 
+	The hash NameKeyGenerator uses to find a name's socket. it's constexpr so that the hash 
+	of a string literal (eg, for a StaticNameKey) can be computed at compile time.
+*/
+//-------------------------------------------------------------------------------------------------
+constexpr UnsignedInt calcNameKeyHash(const char* p)
+{
+	UnsignedInt result = 0; 
+	while (*p) 
+		result = (result << 5) + result + (Byte)*p++; 
+	return result;
+}
+
 //-------------------------------------------------------------------------------------------------
 /** A bucket entry for the name key generator */
 //-------------------------------------------------------------------------------------------------
@@ -68,10 +84,12 @@ public:
 
 	Bucket				*m_nextInSocket;
 	NameKeyType		m_key;
+	UnsignedInt		m_hash;										///< calcNameKeyHash(m_nameString), to skip most strcmps
+	UnsignedInt		m_lowercaseHash;					///< the same, but of the lowercased name, to skip most stricmps
 	AsciiString		m_nameString;
 };
 
-inline Bucket::Bucket() : m_nextInSocket(NULL), m_key(NAMEKEY_INVALID) { }
+inline Bucket::Bucket() : m_nextInSocket(NULL), m_key(NAMEKEY_INVALID), m_hash(0), m_lowercaseHash(0) { }
 inline Bucket::~Bucket() { }
 
 //------------------------------------------------------------------------------------------------- 
@@ -104,9 +122,8 @@ public:
 
 	/** 
 		given a key, return the name. this is almost never needed,
-		except for a few rare cases like object serialization. also
-		note that it's not particularly fast; it does a dumb linear
-		search for the key.
+		except for a few rare cases like object serialization. (it's
+		a simple array lookup, though, so it's not slow.)
 	*/
 	AsciiString keyToName(NameKeyType key);
 
@@ -121,9 +138,18 @@ private:
 		SOCKET_COUNT = 45007
 	};
 
+	friend class StaticNameKey;
+
 	void freeSockets();
 
+	/// nameToKey, for callers that already know calcNameKeyHash(name).
+	NameKeyType nameToKey(const char* name, UnsignedInt hash);
+
+	/// make a new bucket for the name and give it the next key.
+	Bucket *createBucket(const char* name, UnsignedInt hash, UnsignedInt lowercaseHash, UnsignedInt socket);
+
 	Bucket*				m_sockets[SOCKET_COUNT];			///< Catalog of all Buckets already generated
+	std::vector<Bucket*>	m_bucketsByKey;				///< the same Buckets, indexed by key (for keyToName)
 	UnsignedInt		m_nextID;											///< Next available ID
 
 };  // end class NameKeyGenerator
@@ -145,9 +171,12 @@ class StaticNameKey
 private:
 	mutable NameKeyType m_key;
 	const char* m_name;
+	UnsignedInt m_hash;		///< calcNameKeyHash(m_name); computed at compile time for literals
+	NameKeyType lookupKey() const;
 public:
-	StaticNameKey(const char* p) : m_key(NAMEKEY_INVALID), m_name(p) {}
-	NameKeyType key() const;
+	constexpr StaticNameKey(const char* p) : m_key(NAMEKEY_INVALID), m_name(p), m_hash(calcNameKeyHash(p)) {}
+	// after the first call, this is just a load; no function call, and no hashing.
+	inline NameKeyType key() const { return (m_key != NAMEKEY_INVALID) ? m_key : lookupKey(); }
 	// ugh, this is a little hokey, but lets us pretend that a StaticNameKey == NameKeyType
 	inline operator NameKeyType() const { return key(); }
 };
@@ -829,6 +829,9 @@ public:
 
 	void teamAboutToBeDeleted(Team* team);
 
+	/// changes whenever a prototype is added or removed, so anyone caching findTeamPrototype results knows to look again.
+	UnsignedInt getPrototypeGeneration(void) const { return m_prototypeGeneration; }
+
 protected:
 
 	// snapshot methods
@@ -843,6 +846,7 @@ private:
 	TeamPrototypeMap m_prototypes;
 	TeamPrototypeID m_uniqueTeamPrototypeID;		///< used to assign unique ids to each team prototype
 	TeamID m_uniqueTeamID;											///< used to assign unique team ids to each team instance
+	UnsignedInt m_prototypeGeneration;					///< see getPrototypeGeneration(). never 0.
 
 };
 
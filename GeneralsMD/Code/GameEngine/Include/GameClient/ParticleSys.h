@@ -49,6 +49,7 @@
 class Particle;
 class ParticleSystem;
 class ParticleSystemManager;
+struct ParticleUpdateContext;
 class Drawable;
 class Object;
 struct FieldParse;
@@ -170,8 +171,8 @@ public:
 
 	Particle( ParticleSystem *system, const ParticleInfo *data );
 
-	inline Bool update( void );												///< update this particle's behavior - return false if dead
-	void doWindMotion( void );									///< do wind motion (if present) from particle system
+	inline Bool update( const ParticleUpdateContext &ctx );	///< update this particle's behavior - return false if dead
+	void doWindMotion( const ParticleUpdateContext &ctx );	///< do wind motion (if present) from particle system
 
 	void applyForce( const Coord3D *force );		///< add the given acceleration
 
@@ -475,6 +476,23 @@ public:
 
 };
 
+/**
+ * Everything a Particle's update needs from its system that doesn't change while the system
+ * updates its particles.  ParticleSystem::update fills this in once, instead of every particle 
+ * asking the system (and the game client) for it.
+ */
+struct ParticleUpdateContext
+{
+	UnsignedInt												m_frame;					///< current client frame, for the keyframes
+	Coord3D														m_driftVelocity;
+	Real															m_gravity;
+	ParticleSystemInfo::ParticleShaderType	m_shaderType;
+	Bool															m_doWind;					///< if false, the rest are unset
+	Coord3D														m_windCenter;			///< system position, plus what it's attached to
+	Real															m_windCos;				///< Cos and Sin of the system's wind angle
+	Real															m_windSin;
+};
+
 
 /**
  * A ParticleSystemTemplate, used by the ParticleSystemManager to instantiate ParticleSystems.
@@ -553,6 +571,8 @@ public:
 
 	virtual Bool update( Int localPlayerIndex );								///< update this particle system, return false if dead
 	void updateWindMotion( void );							///< update wind motion
+	void fillUpdateContext( ParticleUpdateContext *ctx );	///< gather what our particles' updates need
+	void setAttachedObjectID( ObjectID id );		///< set m_attachedToObjectID, keeping the manager's index up to date
 
 	void setControlParticle( Particle *p );			///< set control particle
 
@@ -719,6 +739,8 @@ public:
 	typedef std::list<ParticleSystem*> ParticleSystemList;
 	typedef std::list<ParticleSystem*>::iterator ParticleSystemListIt;
 	typedef std::unordered_map<AsciiString, ParticleSystemTemplate *, rts::hash<AsciiString>, rts::equal_to<AsciiString> > TemplateMap;
+	typedef std::unordered_map< ParticleSystemID, ParticleSystemListIt, std::hash<UnsignedInt>, std::equal_to<ParticleSystemID> > ParticleSystemIDMap;
+	typedef std::unordered_multimap< ObjectID, ParticleSystem*, std::hash<UnsignedInt>, std::equal_to<ObjectID> > AttachedSystemMap;
 
 	ParticleSystemManager( void );
 	virtual ~ParticleSystemManager();
@@ -782,6 +804,8 @@ public:
 	// these are only for use by partcle systems to link and unlink themselves
 	void friend_addParticleSystem( ParticleSystem *particleSystemToAdd );
 	void friend_removeParticleSystem( ParticleSystem *particleSystemToRemove );
+	void friend_changeParticleSystemID( ParticleSystem *particleSystem, ParticleSystemID oldID );	///< its ID was just changed from oldID
+	void friend_changeAttachedObject( ParticleSystem *particleSystem, ObjectID oldID );	///< its attached object was just changed from oldID
 
 protected:
 
@@ -796,6 +820,8 @@ protected:
 	ParticleSystemID m_uniqueSystemID;					///< unique system ID to assign to each system created
 
 	ParticleSystemList m_allParticleSystemList;
+	ParticleSystemIDMap m_systemIDMap;					///< where each system is in m_allParticleSystemList, by ID
+	AttachedSystemMap m_attachedSystemMap;			///< systems attached to each object
 
 	UnsignedInt m_particleCount;
 	UnsignedInt m_fieldParticleCount; ///< this does not need to be xfered, since it is evaluated every frame
@@ -215,11 +215,28 @@ public:
 	static void releaseACellInfo(PathfindCellInfo *theInfo);
 
 protected:
+	/// A* "open" list binary heap ordering - lowest total cost first, ties go to the earliest inserted.
+	inline static Bool openLess(const PathfindCellInfo *a, const PathfindCellInfo *b)
+	{
+		if (a->m_totalCost != b->m_totalCost) return a->m_totalCost < b->m_totalCost;
+		return a->m_openSequence < b->m_openSequence;
+	}
+	static void openHeapPush(PathfindCellInfo *theInfo);
+	static void openHeapRemove(PathfindCellInfo *theInfo);
+	static void openHeapSiftUp(Int ndx);
+	static void openHeapSiftDown(Int ndx);
+
 	static PathfindCellInfo *s_infoArray;
 	static PathfindCellInfo *s_firstFree;							///< 
 
+	static PathfindCellInfo **s_openHeap;							///< A* "open" list, binary heap indexed by m_openHeapIndex
+	static Int s_openHeapCount;												///< number of cells on the open heap
+	static UnsignedInt s_openSequence;								///< insertion counter, keeps equal cost ordering identical to the old sorted list
 
-	PathfindCellInfo *m_nextOpen, *m_prevOpen;						///< for A* "open" list, shared by closed list
+	PathfindCellInfo *m_nextOpen, *m_prevOpen;						///< for A* "closed" list
+
+	Int m_openHeapIndex;													///< index in s_openHeap, -1 if not on the open heap
+	UnsignedInt m_openSequence;										///< s_openSequence value when put on the open heap
 
 	PathfindCellInfo *m_pathParent;												///< "parent" cell from pathfinder
 	PathfindCell *m_cell;															///< Cell this info belongs to currently.
@@ -315,9 +332,13 @@ public:
 	/// remove all cells from closed list.
 	static Int releaseClosedList( PathfindCell *list );	
 
-	/// remove all cells from closed list.
+	/// remove all cells from open list.
 	static Int releaseOpenList( PathfindCell *list );	
 
+	/// access the open list cells for debug display, in heap order.
+	static Int getOpenListCount( void );
+	static PathfindCell *getOpenListCell( Int ndx );
+
 	inline PathfindCell *getNextOpen(void) {return m_info->m_nextOpen?m_info->m_nextOpen->m_cell:NULL;}
 
 	inline UnsignedShort getXIndex(void) const {return m_info->m_pos.x;}
@@ -441,6 +462,16 @@ private:
 
 enum { PATHFIND_QUEUE_LEN=512};
 
+/// Pathfind queue lanes.  Lower lanes are always served first.
+enum PathfindQueuePriority
+{
+	PATHFIND_PRIORITY_PLAYER = 0,		///< Moves issued by a human player.
+	PATHFIND_PRIORITY_AI,						///< AI & script issued moves.
+	PATHFIND_PRIORITY_IDLE,					///< Delayed re-paths (waiting, stuck, etc.)
+
+	PATHFIND_PRIORITY_COUNT
+};
+
 struct TCheckMovementInfo;
 
 /** 
@@ -466,6 +497,12 @@ public:
 	Bool getInteractsWithBridge(void) const {return m_interactsWithBridge;}
 	void setInteractsWithBridge(Bool interacts) {m_interactsWithBridge = interacts;}
 
+	Bool isModified(void) const {return m_modified;}	///< True if the block is waiting for PathfindZoneManager::updateModifiedZones.
+	void setModified(Bool modified) {m_modified = modified;}
+
+	zoneStorageType getFirstZone(void) const {return m_firstZone;}
+	UnsignedShort getNumZones(void) const {return m_numZones;}
+
 protected:
 	void allocateZones(void);
 	void freeZones(void);
@@ -485,6 +522,7 @@ protected:
 	zoneStorageType *m_crusherZones;
 	Bool					m_interactsWithBridge;
 	Bool					m_markedPassable;
+	Bool					m_modified;
 };
 typedef ZoneBlock *ZoneBlockP;
 
@@ -502,6 +540,7 @@ public:
 	enum {INITIAL_ZONES = 256};
 	enum {ZONE_BLOCK_SIZE = 10};	// Zones are calculated in blocks of 20x20.  This way, the raw zone numbers can be used to 
 	enum {UNINITIALIZED_ZONE = 0};
+	enum {MAX_ZONE = 1<<14};			// Zone numbers have to fit in PathfindCell::m_zone.
 																// compute hierarchically between the 20x20 blocks of cells. jba.
 	PathfindZoneManager();
 	~PathfindZoneManager();
@@ -510,7 +549,8 @@ public:
 
 	Bool needToCalculateZones(void) const {return m_nextFrameToCalculateZones <= TheGameLogic->getFrame() ;} ///< Returns true if the zones need to be recalculated.
  	void markZonesDirty( Bool insert ) ; ///< Called when the zones need to be recalculated.
- 	void updateZonesForModify( PathfindCell **map,  PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds ) ; ///< Called to recalculate an area when a structure has been removed.
+ 	void updateZonesForModify( PathfindCell **map,  PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds ) ; ///< Called to mark an area for update when a structure has been added or removed.
+	void updateModifiedZones( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds ); ///< Recalculates the areas marked by updateZonesForModify.  Once a frame.
 	void calculateZones(	PathfindCell **map, PathfindLayer layers[], const IRegion2D &bounds);	///< Does zone calculations.  
 	zoneStorageType getEffectiveZone(LocomotorSurfaceTypeMask acceptableSurfaces, Bool crusher, zoneStorageType zone) const;
 	zoneStorageType getEffectiveTerrainZone(zoneStorageType zone) const;
@@ -533,10 +573,25 @@ public:
 	void setBridge(Int cellX, Int cellY, Bool bridge);
 	Bool interactsWithBridge(Int cellX, Int cellY) const; 
 
+	UnsignedInt getFullZoneCalculationCount(void) const {return m_fullZoneCalculations;}	///< Number of whole map calculateZones() runs.
+	UnsignedInt getIncrementalZoneUpdateCount(void) const {return m_incrementalZoneUpdates;} ///< Number of modified area updates done without a full recalculation.
+	Real getFullZoneCalculationTime(void) const {return m_fullZoneCalculationTime;} ///< Total milliseconds spent in calculateZones().
+	Real getIncrementalZoneUpdateTime(void) const {return m_incrementalZoneUpdateTime;} ///< Total milliseconds spent in modified area updates.
+	Real getLongestIncrementalZoneUpdateTime(void) const {return m_longestIncrementalZoneUpdateTime;} ///< Longest single modified area update, in milliseconds.
+
 private:
 	void allocateZones(void);
 	void freeZones(void);
 	void freeBlocks(void);
+	void calculateZoneEquivalencies( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds ); ///< Rebuilds the cross block equivalency tables.
+	void applyZoneEquivalencies( PathfindCell **map, PathfindLayer layers[], const IRegion2D &cellBounds, const IRegion2D &globalBounds ); ///< Merges the zones of touching cells into the tables.
+	void flattenZoneEquivalencies(void); ///< Points every table entry at its root.
+	Bool modifiedZonesMaySplit( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds, Int firstNewZone ); ///< True if redoing the modified blocks may have cut a zone in two.
+	void clearModifiedBlocks(void);
+	void fillModifiedZones( PathfindCell **map, const IRegion2D &structureBounds, const IRegion2D &globalBounds ); ///< Quick approximate zones until the next full calculation.
+#if defined _DEBUG || defined _INTERNAL
+	void debugShowZones( PathfindCell **map, const IRegion2D &globalBounds, Int numFramesDuration ); ///< Zone icons for AI_DEBUG_ZONES.
+#endif
 
 private:
 	ZoneBlock			*m_blockOfZoneBlocks;			///< Zone blocks - Info for hierarchical pathfinding at a "blocky" level.
@@ -552,6 +607,15 @@ private:
 	zoneStorageType *m_terrainZones;
 	zoneStorageType *m_crusherZones;
 	zoneStorageType *m_hierarchicalZones;
+
+	UnsignedInt		m_fullZoneCalculations;
+	UnsignedInt		m_incrementalZoneUpdates;
+
+	Real					m_fullZoneCalculationTime;
+	Real					m_incrementalZoneUpdateTime;
+	Real					m_longestIncrementalZoneUpdateTime;
+
+	std::vector<ICoord2D>	m_modifiedBlocks;		///< Zone blocks marked by updateZonesForModify since the last update.
 };
 
 /** 
@@ -629,7 +693,7 @@ public:
 	Bool slowDoesPathExist( Object *obj, const Coord3D *from, 
 		const Coord3D *to, ObjectID ignoreObject=INVALID_ID );  ///< Can we build any path at all between the locations	(terrain, buildings & units check - slower)
 
-	Bool queueForPath(ObjectID id);	 ///< The object wants to request a pathfind, so put it on the list to process.
+	Bool queueForPath(ObjectID id, PathfindQueuePriority priority = PATHFIND_PRIORITY_AI);	 ///< The object wants to request a pathfind, so put it on the list to process.
 	void processPathfindQueue(void); ///< Process some or all of the queued pathfinds.
 	void forceMapRecalculation( );	///< Force pathfind map recomputation. If region is given, only that area is recomputed
 
@@ -862,10 +926,13 @@ private:
 	Int						m_moveAlliesDepth;
 
 
-	// Pathfind queue
-	ObjectID			m_queuedPathfindRequests[PATHFIND_QUEUE_LEN];
-	Int						m_queuePRHead;
-	Int						m_queuePRTail;
+	// Pathfind queue, one ring buffer per priority lane.
+	ObjectID			m_queuedPathfindRequests[PATHFIND_PRIORITY_COUNT][PATHFIND_QUEUE_LEN];
+	Int						m_queuePRHead[PATHFIND_PRIORITY_COUNT];
+	Int						m_queuePRTail[PATHFIND_PRIORITY_COUNT];
+	/** Indexed by ObjectID, 0 if not queued, else 1 + the lane the request is queued in.
+			Promoting a request to a faster lane clears its entry in the slower one. */
+	std::vector<UnsignedByte>	m_queuedPathfindLane;
 	Int						m_cumulativeCellsAllocated;
 };
 
@@ -328,6 +328,10 @@ private:
 	// (for an excellent discussion of priority queues, please see:
 	// http://dogma.net/markn/articles/pq_stl/priority.htm)
 	std::vector<UpdateModulePtr> m_sleepyUpdates;
+
+	// m_sleepyPriorities[i] is always m_sleepyUpdates[i]->friend_getPriority(). the heap
+	// compares these rather than the modules, so rebalancing never touches module memory.
+	std::vector<UnsignedInt> m_sleepyPriorities;
 	
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	// this is a plain old list, not a pq.
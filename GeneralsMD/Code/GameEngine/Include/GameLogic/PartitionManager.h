@@ -76,6 +76,11 @@
 
 const Real HUGE_DIST = 1000000.0f;
 
+enum
+{
+	MAX_GCO_NESTING = 4		///< how deeply getClosestObjects may nest (eg, a filter doing its own query) before it falls back to a slower walk
+};
+
 //-----------------------------------------------------------------------------
 //           Type Definitions                                                      
 //-----------------------------------------------------------------------------
@@ -291,23 +296,28 @@ struct ShroudStatusStoreRestore
 /** 
 	The world's terrain is partitioned into a large grid of Partition Cells.
 	The Cell is the fundamental unit of space in the Partition Manager.
+
+	Note that the per-player shroud, threat, and cash values for a cell don't live here; 
+	the PartitionManager keeps them in per-player planes (see getShroudPlane() et al), 
+	but the accessors below still work a cell at a time.
 */
 //=====================================
 class PartitionCell : public Snapshot	// not MPO: allocated in an array
 {
 private:
 	CellAndObjectIntersection*		m_firstCoiInCell;	///< list of COIs in this cell (may be null).
-	ShroudLevel										m_shroudLevel[MAX_PLAYER_COUNT];	
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	Real													m_loTerrainZ;			///< lowest terrain-pt in this cell
 	Real													m_hiTerrainZ;			///< highest terrain-pt in this cell
 #endif
-	Int														m_threatValue[MAX_PLAYER_COUNT];
-	Int														m_cashValue[MAX_PLAYER_COUNT];
 	Short													m_coiCount;					///< number of COIs in this cell.
 	Short													m_cellX;						///< x-coord of this cell within the Partition Mgr coords (NOT in world coords)
 	Short													m_cellY;						///< y-coord of this cell within the Partition Mgr coords (NOT in world coords)
 
+	inline ShroudLevel& getShroudLevel( Int playerIndex ) const;
+	inline Int& getThreatRef( Int playerIndex ) const;
+	inline Int& getCashRef( Int playerIndex ) const;
+
 public:
 
 	// Note, we allocate these in arrays, thus we must have a default ctor (and NOT descend from MPO)
@@ -344,6 +354,7 @@ public:
 	void removeCashValue( Int playerIndex, UnsignedInt cashValue );
 
 	void invalidateShroudedStatusForAllCois(Int playerIndex);
+	void onShroudStatusChanged(Int playerIndex, CellShroudStatus newShroud);	///< edge trigger for the add/remove looker/shrouder calls
 
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	inline Real getLoTerrain() const { return m_loTerrainZ; }
@@ -394,7 +405,7 @@ private:
 	Int													m_coiArrayCount;					///< number of COIs allocated (may be more than are in use)
 	Int													m_coiInUseCount;					///< number of COIs that are actually in use
 	CellAndObjectIntersection		*m_coiArray;							///< The array of COIs 
-	Int													m_doneFlag;
+	Int													m_doneFlag[MAX_GCO_NESTING];	///< per-nesting-level "already looked at" stamps for getClosestObjects
 	DirtyStatus									m_dirtyStatus;
 	ObjectShroudStatus					m_shroudedness[MAX_PLAYER_COUNT];						
 	ObjectShroudStatus					m_shroudednessPrevious[MAX_PLAYER_COUNT];	///<previous frames value of m_shroudedness						
@@ -551,8 +562,8 @@ public:
 
 	// these are only for use by getClosestObjects.
 	// (note, if we ever use other bits in this, smarten this up...)
-	Int friend_getDoneFlag() { return m_doneFlag; }
-	void friend_setDoneFlag(Int i) { m_doneFlag = i; }
+	Int friend_getDoneFlag(Int depth) { return m_doneFlag[depth]; }
+	void friend_setDoneFlag(Int depth, Int i) { m_doneFlag[depth] = i; }
 
 	inline Bool isInListDirtyModules(PartitionData* const* pListHead) const
 	{
@@ -1248,6 +1259,9 @@ private:
 	Int							m_cellCountY;			///< number of cells, y
 	Int							m_totalCellCount;	///< x * y
 	PartitionCell*	m_cells;					///< array of cells
+	ShroudLevel*		m_shroudPlanes;		///< MAX_PLAYER_COUNT planes of m_totalCellCount shroud levels, each laid out like m_cells
+	Int*						m_threatPlanes;		///< ditto, for threat values
+	Int*						m_cashPlanes;			///< ditto, for cash values
 	PartitionData*	m_dirtyModules;
 	Bool						m_updatedSinceLastReset;	///< Used to force a return of OBJECTSHROUD_INVALID before update has been called.
 
@@ -1295,6 +1309,13 @@ protected:
 	void calcRadiusVec();
 #endif
 
+	// per-player cell data is kept one plane (an m_cellCountX * m_cellCountY grid) per player,
+	// so that sweeps over a single player's cells don't drag everyone else's through the cache.
+	inline ShroudLevel *getShroudPlane(Int playerIndex) const { return m_shroudPlanes + playerIndex * m_totalCellCount; }
+	inline Int *getThreatPlane(Int playerIndex) const { return m_threatPlanes + playerIndex * m_totalCellCount; }
+	inline Int *getCashPlane(Int playerIndex) const { return m_cashPlanes + playerIndex * m_totalCellCount; }
+	friend class PartitionCell;
+
 	// These are all friend functions now. They will continue to function as before, but can be passed into 
 	// the DiscreteCircle::drawCircle function.
 	friend void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndex);
@@ -1408,6 +1429,7 @@ public:
 
 #ifdef DUMP_PERF_STATS
 	void getPMStats(double& gcoTimeThisFrameTotal, double& gcoTimeThisFrameAvg);
+	void getPMContactStats(Int& pairsThisFrame, Int& broadphaseRejectsThisFrame, Int& hitsThisFrame);	///< contact pairs tested in the last update, and how they fared
 #endif
 
 	SimpleObjectIterator *iterateObjectsInRange(
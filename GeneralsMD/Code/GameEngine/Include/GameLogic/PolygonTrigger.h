@@ -81,6 +81,7 @@ protected:
 	mutable Real			m_radius;
 	Int								m_riverStart;	///< Identifies the start point of the river.
 	mutable Bool			m_boundsNeedsUpdate;
+	mutable Bool			m_isAxisAlignedRect;	///< true if the points are an axis-aligned rectangle, so m_bounds is the whole story.
 	Bool							m_exportWithScripts;
 	Bool							m_isWaterArea; ///< Used to specify water areas in the map.
 	Bool							m_isRiver;		///< Used to specify that a water area is a river.
@@ -90,10 +91,13 @@ protected:
 
 	static PolygonTrigger* ThePolygonTriggerListPtr;
 	static Int s_currentID; ///< Current id for new triggers.
+	static Bool s_triggerIndexValid; ///< False if triggers have changed since the trigger index was built.
 
 protected:
 	void reallocate(void);
 	void updateBounds(void) const;
+	Bool calcIsAxisAlignedRect(void) const;
+	static void buildTriggerIndex(void);
 
 	// snapshot methods
 	virtual void crc( Xfer *xfer );
@@ -111,11 +115,15 @@ public:
 	/// Writes Triggers Info
 	static void WritePolygonTriggersDataChunk(DataChunkOutput &chunkWriter);
 	static void deleteTriggers(void);
+	/** Returns the triggers whose bounds contain point, in list order, so callers that walked
+		the whole list get the same answers. Only good until the triggers change. */
+	static PolygonTrigger* const* getTriggersAt(const ICoord3D &point, Bool waterAreasOnly, Int *count);
+	static void invalidateTriggerIndex(void) {s_triggerIndexValid = false;}
 
 public:
 	static void addPolygonTrigger(PolygonTrigger *pTrigger);
 	static void removePolygonTrigger(PolygonTrigger *pTrigger);
-	void setNextPoly(PolygonTrigger *nextPoly) {m_nextPolygonTrigger = nextPoly;} ///< Link the next map object.
+	void setNextPoly(PolygonTrigger *nextPoly) {m_nextPolygonTrigger = nextPoly; invalidateTriggerIndex();} ///< Link the next map object.
 	void addPoint(const ICoord3D &point);
 	void setPoint(const ICoord3D &point, Int ndx);
 	void insertPoint(const ICoord3D &point, Int ndx);
@@ -145,7 +153,7 @@ public:
 	Bool doExportWithScripts(void) const {return m_exportWithScripts;} 
 	void setDoExportWithScripts(Bool val) {m_exportWithScripts = val;} 
 	Bool isWaterArea(void) const {return m_isWaterArea;} 
-	void setWaterArea(Bool val) {m_isWaterArea = val;} 
+	void setWaterArea(Bool val) {m_isWaterArea = val; invalidateTriggerIndex();} 
 	Bool isRiver(void) const {return m_isRiver;} 
 	void setRiver(Bool val) {m_isRiver = val;} 
 	Int getRiverStart(void) const {return m_riverStart;} 
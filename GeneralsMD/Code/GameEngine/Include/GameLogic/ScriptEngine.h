@@ -395,7 +395,13 @@ protected:
 	Bool evaluateFlag( Condition *pCondition );
 	Bool evaluateTimer( Condition *pCondition );
 	Bool evaluateCondition( Condition *pCondition );
+	Bool evaluateCompiledConditions( CompiledCondition *steps, Int numSteps, Bool snapshotReads );
+	void snapshotConditionReads( CompiledCondition *step );
+	Bool conditionReadsUnchanged( const CompiledCondition *steps, Int numSteps );
 	void executeActions( ScriptAction *pActionHead );
+	void executeScriptActions( Script *pScript, ScriptAction *pActionHead );	///< executeActions, timed if profiling.
+	void clearScriptProfile( void );
+	void writeScriptProfile( void );	///< Writes the -profileScripts report for the current map.
 
 	void setPriorityThing( ScriptAction *pAction );
 	void setPriorityKind( ScriptAction *pAction );
@@ -486,6 +492,11 @@ protected:
 	
 	Bool							m_shownMPLocalDefeatWindow;
 
+	Bool							m_profiling;				///< TheGlobalData->m_profileScripts; collect data for writeScriptProfile.
+	Int								m_profileFrames;		///< Updates since the profile was cleared.
+	ScriptProfileStat	m_conditionTypeProfile[Condition::NUM_ITEMS];	///< Time in each kind of condition.
+	ScriptProfileStat	m_sequentialScriptProfile;	///< Time in evaluateAndProgressAllSequentialScripts each frame.
+
 #ifdef SPECIAL_SCRIPT_PROFILING
 #ifdef DEBUG_LOGGING
 	double						m_numFrames;
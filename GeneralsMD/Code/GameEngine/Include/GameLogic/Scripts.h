@@ -73,6 +73,7 @@
 
 class Parameter;
 class Script;
+class TeamPrototype;
 class OrCondition;
 class Condition;
 class DataChunkInput;
@@ -596,6 +597,44 @@ protected:
 
 };
 
+//-------------------------------------------------------------------------------------------------
+/** Accumulated timings for the script profile report (-profileScripts). */
+struct ScriptProfileStat
+{
+	Int		m_count;			///< number of samples.
+	Real	m_totalTime;	///< seconds, all samples.
+	Real	m_maxTime;		///< seconds, longest single sample.
+
+	ScriptProfileStat() {clear();}
+	void clear(void) {m_count = 0; m_totalTime = 0; m_maxTime = 0;}
+	void addSample(Real time) {m_count++; m_totalTime += time; if (time > m_maxTime) m_maxTime = time;}
+};
+
+//-------------------------------------------------------------------------------------------------
+/** One step of a script's compiled condition list. The or/and lists are flattened in order,
+so evaluating from step 0 gives the same short circuit behavior as walking the lists. */
+struct CompiledCondition
+{
+	/// what a condition's result depends on, so the script engine can tell when it can't have changed.
+	enum Reads
+	{
+		READS_UNKNOWN,				///< anything at all.  Scripts with one of these are always evaluated.
+		READS_NOTHING,				///< constant.
+		READS_COUNTER,				///< counter (or timer) in parameter 0.
+		READS_FLAG,						///< flag in parameter 0.
+		READS_OBJECT_COUNT		///< caches its own result until the object count changes.
+	};
+
+	Condition	*m_condition;
+	Int				m_onFalse;			///< step to go to if m_condition is false (the next or clause). >= count means the script is false.
+	Bool			m_endsAndTerm;	///< if m_condition is true and this is set, the script is true.
+	Reads			m_reads;
+	Bool			m_readEvaluated;	///< true if this step was reached in the last evaluation; the rest are below.
+	Int				m_readIndex;		///< counter/flag slot at the last evaluation (0 if not allocated yet)...
+	Int				m_readValue;		///< ...its value (for object counts, the condition's custom data)...
+	Bool			m_readTimerRunning;	///< ...and for counters, whether it was counting down.
+};
+
 //-------------------------------------------------------------------------------------------------
 // ******************************** class Script ***********************************************
 //-------------------------------------------------------------------------------------------------
@@ -635,6 +674,18 @@ protected:	// Note - If you add any member vars, you must take them into account
 	Real				m_conditionTime;		///< Amount of time (cum) to evaluate conditions.
 	Real				m_curTime;		///< Amount of time (cum) to evaluate conditions.
 	Int					m_conditionExecutedCount; ///< Number of times conditions evaluated.
+	CompiledCondition *m_compiledConditions;	///< Flattened m_condition, built on first use.  NULL if not built.
+	Int					m_numCompiledConditions;
+	TeamPrototype *m_conditionTeamPrototype;	///< Cached lookup of m_conditionTeamName...
+	UnsignedInt	m_conditionTeamGeneration;		///< ...valid while the team factory's prototype generation matches this.
+	Bool				m_conditionsCacheable;		///< True if every compiled condition says what it reads.
+	Bool				m_hasCachedResult;				///< True if m_cachedResult is from an evaluation whose reads are snapshotted in m_compiledConditions.
+	Bool				m_cachedResult;
+	Bool				m_verifyCachedResult;			///< Debug aid: when the cached result is used, evaluate anyway and complain if they differ.
+	ScriptProfileStat m_conditionProfile;	///< Condition evaluation times, when profiling.
+	ScriptProfileStat m_actionProfile;		///< Action (true or false) execution times, when profiling.
+
+	void compileConditions(void);
 
 public:
 	Script();
@@ -656,7 +707,7 @@ public:
 	void setHard(Bool hard) { m_hard = hard;}
 	void setSubroutine(Bool subr) { m_isSubroutine = subr;}
 	void setNextScript(Script *pScr) {m_nextScript = pScr;}
-	void setOrCondition(OrCondition *pCond) {m_condition = pCond;}
+	void setOrCondition(OrCondition *pCond) {m_condition = pCond; invalidateCompiledConditions();}
 	void setAction(ScriptAction *pAction) {m_action = pAction;}
 	void setFalseAction(ScriptAction *pAction) {m_actionFalse = pAction;}
 	void updateFrom(Script *pSrc); ///< Updates this from pSrc.  pSrc IS MODIFIED - it's guts are removed.  jba.
@@ -664,12 +715,17 @@ public:
 	void incrementConditionCount(void) {m_conditionExecutedCount++;}
 	void addToConditionTime(Real time) {m_conditionTime += time;}
 	void setCurTime(Real time) {m_curTime	= time;}
+	void addConditionProfileSample(Real time) {m_conditionProfile.addSample(time);}
+	void addActionProfileSample(Real time) {m_actionProfile.addSample(time);}
+	void clearProfile(void) {m_conditionProfile.clear(); m_actionProfile.clear();}
 	void setDelayEvalSeconds(Int delay) {m_delayEvaluationSeconds = delay;}
 
 	UnsignedInt getFrameToEvaluate(void) {return m_frameToEvaluateAt;}
 	Int getConditionCount(void) {return m_conditionExecutedCount;}
 	Real getConditionTime(void) {return m_conditionTime;}
 	Real getCurTime(void) {return m_curTime;}
+	const ScriptProfileStat &getConditionProfile(void) const {return m_conditionProfile;}
+	const ScriptProfileStat &getActionProfile(void) const {return m_actionProfile;}
 	Int getDelayEvalSeconds(void) {return m_delayEvaluationSeconds;}
 
 	AsciiString getName(void) const { return m_scriptName;}
@@ -685,6 +741,18 @@ public:
 	Bool isSubroutine(void) const { return m_isSubroutine;}
 	Script *getNext(void) const {return m_nextScript;}
 	OrCondition *getOrCondition(void) const {return m_condition;}
+	const CompiledCondition *getCompiledConditions(Int *count);	///< Builds them if need be.
+	void invalidateCompiledConditions(void);	///< Call if the condition lists are edited in place.
+
+	// Support for ScriptEngine's condition result cache.
+	Bool areConditionsCacheable(void) const {return m_conditionsCacheable && m_compiledConditions != NULL;}
+	CompiledCondition *friend_getCompiledConditions(void) {return m_compiledConditions;}
+	Bool hasCachedResult(void) const {return m_hasCachedResult;}
+	Bool getCachedResult(void) const {return m_cachedResult;}
+	void setCachedResult(Bool result) {m_cachedResult = result; m_hasCachedResult = true;}
+	void clearCachedResult(void) {m_hasCachedResult = false;}
+	Bool isVerifyingCachedResult(void) const {return m_verifyCachedResult;}
+	void setVerifyCachedResult(Bool verify) {m_verifyCachedResult = verify;}
 	ScriptAction *getAction(void) const	{return m_action;}
 	ScriptAction *getFalseAction(void) const {return m_actionFalse;}
 	AsciiString getUiText(void);
@@ -703,7 +771,8 @@ public:
 
 	// Support routines for ScriptEngine - 
 	AsciiString getConditionTeamName(void) {return m_conditionTeamName;}
-	void setConditionTeamName(AsciiString teamName) {m_conditionTeamName = teamName;}
+	void setConditionTeamName(AsciiString teamName) {m_conditionTeamName = teamName; m_conditionTeamGeneration = 0;}
+	TeamPrototype *getConditionTeamPrototype(void);	///< findTeamPrototype(m_conditionTeamName), cached.
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -373,6 +373,15 @@ Int parseFullVersion(char *args[], int num)
 	return 1;
 }
 
+Int parseReleaseEmptyPoolBlobs(char *args[], int)
+{
+	if (TheMemoryPoolFactory)
+	{
+		TheMemoryPoolFactory->setReleaseEmptyOverflowBlobs(true);
+	}
+	return 1;
+}
+
 Int parseNoShadows(char *args[], int)
 {
 	if (TheWritableGlobalData)
@@ -608,6 +617,15 @@ Int parseScriptDebug(char *args[], int)
 	return 1;
 }
 
+Int parseProfileScripts(char *args[], int)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_profileScripts = TRUE;
+	}
+	return 1;
+}
+
 Int parseParticleEdit(char *args[], int)
 {
 	if (TheWritableGlobalData)
@@ -1141,10 +1159,12 @@ static CommandLineParam params[] =
 	{ "-fullVersion", parseFullVersion },
 	{	"-particleEdit", parseParticleEdit },
 	{ "-scriptDebug", parseScriptDebug },
+	{ "-profileScripts", parseProfileScripts },
 	{ "-playStats", parsePlayStats },
 	{ "-mod", parseMod },
 	{ "-noshaders", parseNoShaders },
 	{ "-quickstart", parseQuickStart },
+	{ "-releaseEmptyPoolBlobs", parseReleaseEmptyPoolBlobs },
 
 #if (defined(_DEBUG) || defined(_INTERNAL))
 	{ "-noaudio", parseNoAudio },
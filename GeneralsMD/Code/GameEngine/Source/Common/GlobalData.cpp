@@ -633,6 +633,7 @@ GlobalData::GlobalData()
 	m_textureReductionFactor = -1;
 	m_enableBehindBuildingMarkers = TRUE;
 	m_scriptDebug = FALSE;
+	m_profileScripts = FALSE;
 	m_particleEdit = FALSE;
 	m_displayDebug = FALSE;
 	m_winCursors = TRUE;
@@ -38,6 +38,7 @@
 #include "Common/File.h"
 #include "Common/FileSystem.h"
 #include "Common/GameAudio.h"
+#include "Common/NameKeyGenerator.h"
 #include "Common/Science.h"
 #include "Common/SpecialPower.h"
 #include "Common/ThingFactory.h"
@@ -71,6 +72,38 @@
 
 static Xfer *s_xfer = NULL;
 
+//-------------------------------------------------------------------------------------------------
+/** Every line of every block looks its field token up in one or more parse tables, and walking
+	* those with strcmp adds up (the Object tables alone run to hundreds of lines per file). So the
+	* first time we see a parse table we hash its tokens into a little open-addressed index. Parse
+	* tables all live in static storage, so the table address is a fine key. The indices live in
+	* fixed arrays (no heap, nothing to tear down); if we ever run out of room, that table just
+	* falls back to the linear scan. */
+//-------------------------------------------------------------------------------------------------
+struct FieldParseSlot
+{
+	UnsignedInt				hash;						///< calcNameKeyHash(parse->token)
+	const FieldParse*	parse;					///< NULL if this slot is empty
+};
+
+struct FieldParseIndex
+{
+	const FieldParse*	table;					///< NULL if this index is unused
+	const FieldParse*	terminator;			///< the table's NULL-token entry (may hold a catch-all parser)
+	FieldParseSlot*		slots;					///< NULL if the table didn't fit; use the linear scan
+	UnsignedInt				mask;						///< slot count - 1
+};
+
+enum
+{
+	FIELD_PARSE_INDEX_COUNT	= 2048,		///< max number of distinct parse tables (must be a power of 2)
+	FIELD_PARSE_SLOT_COUNT	= 32768		///< total hash slots shared by all the tables
+};
+
+static FieldParseIndex theFieldParseIndices[FIELD_PARSE_INDEX_COUNT];
+static FieldParseSlot theFieldParseSlots[FIELD_PARSE_SLOT_COUNT];
+static Int theFieldParseSlotsUsed = 0;
+
 //-------------------------------------------------------------------------------------------------
 /** This is the table of data types we can have in INI files.  To add a new data type
 	* block make a new entry in this table and add an appropriate parsing function */
@@ -321,24 +354,113 @@ static INIBlockParse findBlockParse(const char* token)
 }
 
 //-------------------------------------------------------------------------------------------------
-static INIFieldParseProc findFieldParse(const FieldParse* parseTable, const char* token, int& offset, void*& userData)
+static void buildFieldParseIndex(FieldParseIndex& index, const FieldParse* parseTable)
 {
+	index.table = parseTable;
+	index.slots = NULL;
+	index.mask = 0;
+
 	const FieldParse* parse = parseTable;
 	for (; parse->token; ++parse)
+		;
+	index.terminator = parse;
+
+	// keep the load factor at 1/2 or less
+	UnsignedInt count = (UnsignedInt)(index.terminator - parseTable);
+	UnsignedInt size = 4;
+	while (size < count * 2)
+		size <<= 1;
+
+	if (theFieldParseSlotsUsed + (Int)size > FIELD_PARSE_SLOT_COUNT)
 	{
-		if (strcmp( parse->token, token ) == 0)
+		DEBUG_CRASH(("out of INI field parse slots, increase FIELD_PARSE_SLOT_COUNT (the linear scan still works)"));
+		return;
+	}
+
+	index.slots = &theFieldParseSlots[theFieldParseSlotsUsed];
+	index.mask = size - 1;
+	theFieldParseSlotsUsed += size;
+
+	for (parse = parseTable; parse->token; ++parse)
+	{
+		UnsignedInt hash = calcNameKeyHash(parse->token);
+		for (UnsignedInt s = hash & index.mask; ; s = (s + 1) & index.mask)
 		{
-			offset = parse->offset;
-			userData = (void*)parse->userData;
-			return parse->parse;
+			FieldParseSlot& slot = index.slots[s];
+			if (slot.parse == NULL)
+			{
+				slot.hash = hash;
+				slot.parse = parse;
+				break;
+			}
+
+			// a token listed twice: the linear scan always found the first one, so keep that.
+			if (slot.hash == hash && strcmp(slot.parse->token, parse->token) == 0)
+				break;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+static const FieldParseIndex* getFieldParseIndex(const FieldParse* parseTable)
+{
+	UnsignedInt i = ((UnsignedInt)(size_t)parseTable >> 4) & (FIELD_PARSE_INDEX_COUNT - 1);
+	for (Int probes = 0; probes < FIELD_PARSE_INDEX_COUNT; ++probes, i = (i + 1) & (FIELD_PARSE_INDEX_COUNT - 1))
+	{
+		FieldParseIndex& index = theFieldParseIndices[i];
+		if (index.table == parseTable)
+			return &index;
+
+		if (index.table == NULL)
+		{
+			buildFieldParseIndex(index, parseTable);
+			return &index;
+		}
+	}
+
+	DEBUG_CRASH(("out of INI field parse indices, increase FIELD_PARSE_INDEX_COUNT (the linear scan still works)"));
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+static INIFieldParseProc findFieldParse(const FieldParse* parseTable, const char* token, UnsignedInt tokenHash, int& offset, void*& userData)
+{
+	const FieldParse* terminator = NULL;
+	const FieldParseIndex* index = getFieldParseIndex(parseTable);
+	if (index && index->slots)
+	{
+		for (UnsignedInt s = tokenHash & index->mask; index->slots[s].parse; s = (s + 1) & index->mask)
+		{
+			const FieldParseSlot& slot = index->slots[s];
+			if (slot.hash == tokenHash && strcmp(slot.parse->token, token) == 0)
+			{
+				offset = slot.parse->offset;
+				userData = (void*)slot.parse->userData;
+				return slot.parse->parse;
+			}
+		}
+		terminator = index->terminator;
+	}
+	else
+	{
+		const FieldParse* parse = parseTable;
+		for (; parse->token; ++parse)
+		{
+			if (strcmp( parse->token, token ) == 0)
+			{
+				offset = parse->offset;
+				userData = (void*)parse->userData;
+				return parse->parse;
+			}
 		}
+		terminator = parse;
 	}
 
-	if (!parse->token && parse->parse) 
+	if (terminator->parse) 
 	{
-		offset = parse->offset;
+		offset = terminator->offset;
 		userData = (void*)token;
-		return parse->parse;
+		return terminator->parse;
 	}
 	else
 	{
@@ -1502,11 +1624,12 @@ void INI::initFromINIMulti( void *what, const MultiIniFieldParse& parseTableList
 			else
 			{
 				Bool found = false;
+				UnsignedInt fieldHash = calcNameKeyHash(field);
 				for (int ptIdx = 0; ptIdx < parseTableList.getCount(); ++ptIdx)
 				{
 					int offset = 0;
 					void* userData = 0;
-					INIFieldParseProc parse = findFieldParse(parseTableList.getNthFieldParse(ptIdx), field, offset, userData);
+					INIFieldParseProc parse = findFieldParse(parseTableList.getNthFieldParse(ptIdx), field, fieldHash, offset, userData);
 					if (parse)
 					{
 						// parse this block and check for parse errors
@@ -85,19 +85,10 @@ void NameKeyGenerator::freeSockets()
 		}
 		m_sockets[i] = NULL;
 	}
+	m_bucketsByKey.clear();
 
 }  // end freeSockets
 
-/* ------------------------------------------------------------------------ */
-inline UnsignedInt calcHashForString(const char* p)
-{
-	UnsignedInt result = 0; 
-	Byte *pp = (Byte*)p;
-	while (*pp) 
-		result = (result << 5) + result + *pp++; 
-	return result;
-}
-
 /* ------------------------------------------------------------------------ */
 inline UnsignedInt calcHashForLowercaseString(const char* p)
 {
@@ -111,39 +102,29 @@ inline UnsignedInt calcHashForLowercaseString(const char* p)
 //------------------------------------------------------------------------------------------------- 
 AsciiString NameKeyGenerator::keyToName(NameKeyType key)
 {
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
+	if ((UnsignedInt)key < (UnsignedInt)m_bucketsByKey.size())
 	{
-		for (Bucket *b = m_sockets[i]; b; b = b->m_nextInSocket)
-		{
-			if (key == b->m_key)
-				return b->m_nameString;
-		}
+		Bucket *b = m_bucketsByKey[key];
+		if (b)
+			return b->m_nameString;
 	}
 	return AsciiString::TheEmptyString;
 }
 
 //------------------------------------------------------------------------------------------------- 
-NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
+Bucket *NameKeyGenerator::createBucket(const char* nameString, UnsignedInt hash, UnsignedInt lowercaseHash, UnsignedInt socket)
 {
-	Bucket *b;
-
-	UnsignedInt hash = calcHashForString(nameString) % SOCKET_COUNT;
-
-	// hmm, do we have it already?
-	for (b = m_sockets[hash]; b; b = b->m_nextInSocket)
-	{
-		if (strcmp(nameString, b->m_nameString.str()) == 0)
-			return b->m_key; 
-	}
-
-	// nope, guess not. let's allocate it.
-	b = newInstance(Bucket);
+	Bucket *b = newInstance(Bucket);
 	b->m_key = (NameKeyType)m_nextID++;
+	b->m_hash = hash;
+	b->m_lowercaseHash = lowercaseHash;
 	b->m_nameString = nameString;
-	b->m_nextInSocket = m_sockets[hash];
-	m_sockets[hash] = b;
+	b->m_nextInSocket = m_sockets[socket];
+	m_sockets[socket] = b;
 
-	NameKeyType result = b->m_key;
+	if (m_bucketsByKey.size() <= (UnsignedInt)b->m_key)
+		m_bucketsByKey.resize(b->m_key + 1, NULL);
+	m_bucketsByKey[b->m_key] = b;
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	// reality-check to be sure our hasher isn't going bad.
@@ -152,7 +133,7 @@ NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
 	for (Int i = 0; i < SOCKET_COUNT; ++i)
 	{
 		Int numInThisSocket = 0;
-		for (b = m_sockets[i]; b; b = b->m_nextInSocket)
+		for (Bucket *c = m_sockets[i]; c; c = c->m_nextInSocket)
 			++numInThisSocket;
 
 		if (numInThisSocket > maxThresh)
@@ -166,55 +147,61 @@ NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
 	}
 #endif
 
-	return result;
+	return b;
+}
+
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
+{
+	return nameToKey(nameString, calcNameKeyHash(nameString));
 
 }  // end nameToKey
 
 //------------------------------------------------------------------------------------------------- 
-NameKeyType NameKeyGenerator::nameToLowercaseKey(const char* nameString)
+NameKeyType NameKeyGenerator::nameToKey(const char* nameString, UnsignedInt hash)
 {
+	DEBUG_ASSERTCRASH(hash == calcNameKeyHash(nameString), ("bad precomputed hash for %s",nameString));
+
 	Bucket *b;
 
-	UnsignedInt hash = calcHashForLowercaseString(nameString) % SOCKET_COUNT;
+	UnsignedInt socket = hash % SOCKET_COUNT;
 
-	// hmm, do we have it already?
-	for (b = m_sockets[hash]; b; b = b->m_nextInSocket)
+	// hmm, do we have it already? (the full hash filters out nearly all the strcmps, and
+	// a string that was handed out by us, or shares its buffer, is matched by pointer.)
+	for (b = m_sockets[socket]; b; b = b->m_nextInSocket)
 	{
-		if (_stricmp(nameString, b->m_nameString.str()) == 0)
+		if (b->m_hash != hash)
+			continue;
+
+		const char* bucketString = b->m_nameString.str();
+		if (bucketString == nameString || strcmp(nameString, bucketString) == 0)
 			return b->m_key; 
 	}
 
 	// nope, guess not. let's allocate it.
-	b = newInstance(Bucket);
-	b->m_key = (NameKeyType)m_nextID++;
-	b->m_nameString = nameString;
-	b->m_nextInSocket = m_sockets[hash];
-	m_sockets[hash] = b;
+	b = createBucket(nameString, hash, calcHashForLowercaseString(nameString), socket);
+	return b->m_key;
 
-	NameKeyType result = b->m_key;
+}  // end nameToKey
 
-#if defined(_DEBUG) || defined(_INTERNAL)
-	// reality-check to be sure our hasher isn't going bad.
-	const Int maxThresh = 3;
-	Int numOverThresh = 0;
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
-	{
-		Int numInThisSocket = 0;
-		for (b = m_sockets[i]; b; b = b->m_nextInSocket)
-			++numInThisSocket;
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::nameToLowercaseKey(const char* nameString)
+{
+	Bucket *b;
 
-		if (numInThisSocket > maxThresh)
-			++numOverThresh;
-	}
-	
-	// if more than a small percent of the sockets are getting deep, probably want to increase the socket count.
-	if (numOverThresh > SOCKET_COUNT/20)
+	UnsignedInt lowercaseHash = calcHashForLowercaseString(nameString);
+	UnsignedInt socket = lowercaseHash % SOCKET_COUNT;
+
+	// hmm, do we have it already?
+	for (b = m_sockets[socket]; b; b = b->m_nextInSocket)
 	{
-		DEBUG_CRASH(("hmm, might need to increase the number of bucket-sockets for NameKeyGenerator (numOverThresh %d = %f%%)\n",numOverThresh,(Real)numOverThresh/(Real)(SOCKET_COUNT/20)));
+		if (b->m_lowercaseHash == lowercaseHash && _stricmp(nameString, b->m_nameString.str()) == 0)
+			return b->m_key; 
 	}
-#endif
 
-	return result;
+	// nope, guess not. let's allocate it.
+	b = createBucket(nameString, calcNameKeyHash(nameString), lowercaseHash, socket);
+	return b->m_key;
 
 }  // end nameToLowercaseKey
 
@@ -228,13 +215,13 @@ void NameKeyGenerator::parseStringAsNameKeyType( INI *ini, void *instance, void
 
 
 //------------------------------------------------------------------------------------------------- 
-NameKeyType StaticNameKey::key() const
+NameKeyType StaticNameKey::lookupKey() const
 {
 	if (m_key == NAMEKEY_INVALID)
 	{
 		DEBUG_ASSERTCRASH(TheNameKeyGenerator, ("no TheNameKeyGenerator yet"));
 		if (TheNameKeyGenerator)
-			m_key = TheNameKeyGenerator->nameToKey(m_name);
+			m_key = TheNameKeyGenerator->nameToKey(m_name, m_hash);
 	}
 	return m_key;
 }
@@ -177,6 +177,7 @@ TeamFactory::TeamFactory()
 
 	m_uniqueTeamPrototypeID = TEAM_PROTOTYPE_ID_INVALID;
 	m_uniqueTeamID = TEAM_ID_INVALID;
+	m_prototypeGeneration = 1;
 
 }
 
@@ -212,6 +213,8 @@ void TeamFactory::clear()
 		// the TeamProto will try to remove itself from the list when it goes away
 	TeamPrototypeMap tmp = m_prototypes;
 	m_prototypes.clear();
+	if (++m_prototypeGeneration == 0)
+		m_prototypeGeneration = 1;
 	for (TeamPrototypeMap::iterator it = tmp.begin(); it != tmp.end(); ++it)
 	{
 		it->second->deleteInstance();
@@ -263,6 +266,8 @@ void TeamFactory::addTeamPrototypeToList(TeamPrototype* team)
 	}
 
 	m_prototypes[nk] = team;
+	if (++m_prototypeGeneration == 0)
+		m_prototypeGeneration = 1;
 }
 
 //=============================================================================
@@ -271,7 +276,11 @@ void TeamFactory::removeTeamPrototypeFromList(TeamPrototype* team)
 	NameKeyType nk = NAMEKEY(team->getName());
 	TeamPrototypeMap::iterator it = m_prototypes.find(nk);
 	if (it != m_prototypes.end())
+	{
 		m_prototypes.erase(it);
+		if (++m_prototypeGeneration == 0)
+			m_prototypeGeneration = 1;
+	}
 }
 
 // ------------------------------------------------------------------------
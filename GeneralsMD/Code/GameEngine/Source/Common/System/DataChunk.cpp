@@ -52,9 +52,20 @@ CachedFileInputStream::~CachedFileInputStream(void)
 
 Bool CachedFileInputStream::open(AsciiString path)
 {
-	File *file=TheFileSystem->openFile(path.str(), File::READ | File::BINARY);
+	File *file = NULL;
 	m_size = 0;
 
+	// if somebody prefetched this, the data may already be read and decompressed.
+	char *prefetched = NULL;
+	Int prefetchedSize = 0;
+	if (TheFileSystem->takePrefetchedData(path.str(), TRUE, prefetched, prefetchedSize)) {
+		m_buffer = prefetched;
+		m_size = prefetchedSize;
+		m_pos=0;
+	} else {
+		file=TheFileSystem->openFile(path.str(), File::READ | File::BINARY);
+	}
+
 	if (file) {
 		m_size=file->size();
 		if (m_size) {
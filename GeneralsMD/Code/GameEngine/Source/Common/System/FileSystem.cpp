@@ -54,6 +54,10 @@
 #include "Common/GameAudio.h"
 #include "Common/LocalFileSystem.h"
 #include "Common/PerfTimer.h"
+#include "Common/RAMFile.h"
+#include "Compression.h"
+#include "mutex.h"
+#include "thread.h"
 
 
 DECLARE_PERF_TIMER(FileSystem)
@@ -68,12 +72,103 @@ DECLARE_PERF_TIMER(FileSystem)
 //         Defines                                                         
 //----------------------------------------------------------------------------
 
+static const Int NumPrefetchThreads = 2;
+static const Int MaxPrefetchBytes = 32 * 1024 * 1024;	///< workers stop reading ahead once this much is waiting to be opened
+
 
 
 //----------------------------------------------------------------------------
 //         Private Types                                                     
 //----------------------------------------------------------------------------
 
+class FilePrefetchThread;
+
+//===============================
+// FilePrefetcher
+//===============================
+/**
+	* Reads archived files on worker threads ahead of whoever is going to open
+	* them, and parks the data until FileSystem::openFile or takePrefetchedData
+	* hands the buffer over.  Only files that come out of an archive get
+	* prefetched; a local file always wins in openFile, so those are skipped.
+	*
+	* Each prefetched buffer is consumed by the first open of its name.  Opening
+	* a name that is still queued or being read counts as a miss, and the open
+	* goes to the archive like it always did.
+	*/
+//===============================
+class FilePrefetcher
+{
+public:
+	FilePrefetcher();
+	~FilePrefetcher();
+
+	void submit( const AsciiString& filename, Bool decompress );
+	void flush( void );
+	Bool take( const AsciiString& filename, Bool decompressed, char *&data, Int &size );
+
+	Bool processRequest( void );	///< worker thread side, FALSE if there was nothing it could do
+
+private:
+	enum EntryState
+	{
+		PREFETCH_PENDING,		///< queued or being read
+		PREFETCH_READY			///< data is waiting to be taken
+	};
+
+	struct Request
+	{
+		AsciiString m_key;
+		AsciiString m_filename;
+		Bool				m_decompress;
+	};
+
+	struct Entry
+	{
+		EntryState	m_state;
+		char				*m_data;
+		Int					m_size;
+		Bool				m_decompressed;	///< m_data is unpacked, so only takePrefetchedData callers can use it
+	};
+
+	typedef std::list<Request> RequestList;
+	typedef std::unordered_map<AsciiString, Entry, rts::hash<AsciiString>, rts::equal_to<AsciiString> > EntryMap;
+
+	static AsciiString makeKey( const AsciiString& filename );
+	void startThreads( void );
+	void stopThreads( void );
+
+	CriticalSectionClass	m_lock;			///< guards everything below
+	RequestList						m_requests;
+	EntryMap							m_entries;
+	Int										m_cachedBytes;	///< bytes sitting in PREFETCH_READY entries
+	UnsignedInt						m_generation;		///< bumped by flush so reads that were in flight get thrown away
+
+	Int										m_hits;					///< opens served from a prefetched buffer
+	Int										m_misses;				///< opens of a name that was submitted but not read yet
+	Int										m_wasted;				///< buffers read but never opened
+	Int										m_bytesPrefetched;
+
+	FilePrefetchThread		*m_threads[NumPrefetchThreads];
+};
+
+//===============================
+// FilePrefetchThread
+//===============================
+class FilePrefetchThread : public ThreadClass
+{
+public:
+	FilePrefetchThread( FilePrefetcher *prefetcher ) : ThreadClass("FilePrefetch"), m_prefetcher(prefetcher), m_started(FALSE) {}
+
+	Bool hasStarted( void ) const { return m_started; }	///< true once the thread itself is up and has set 'running'
+
+protected:
+	virtual void Thread_Function();
+
+	FilePrefetcher *m_prefetcher;
+	volatile Bool m_started;
+};
+
 
 
 //----------------------------------------------------------------------------
@@ -117,11 +212,311 @@ FileSystem	*TheFileSystem = NULL;
 //----------------------------------------------------------------------------
 
 
+//============================================================================
+// FilePrefetchThread::Thread_Function
+//============================================================================
+
+void FilePrefetchThread::Thread_Function()
+{
+	ScopedThreadMemoryPoolCaches threadCaches;
+	m_started = TRUE;
+
+	try {
+		while ( running )
+		{
+			// nothing queued, or the cache is full and waiting on somebody to open what's in it.
+			if (!m_prefetcher->processRequest())
+				Sleep_Ms(1);
+		}
+	} catch ( ... ) {
+		DEBUG_CRASH(("Exception in file prefetch thread!"));
+	}
+}
+
+//============================================================================
+// FilePrefetcher::FilePrefetcher
+//============================================================================
+
+FilePrefetcher::FilePrefetcher() :
+	m_cachedBytes(0),
+	m_generation(0),
+	m_hits(0),
+	m_misses(0),
+	m_wasted(0),
+	m_bytesPrefetched(0)
+{
+	for (Int i = 0; i < NumPrefetchThreads; ++i)
+		m_threads[i] = NULL;
+}
+
+//============================================================================
+// FilePrefetcher::~FilePrefetcher
+//============================================================================
+
+FilePrefetcher::~FilePrefetcher()
+{
+	flush();
+}
+
+//============================================================================
+// FilePrefetcher::makeKey
+//============================================================================
+
+AsciiString FilePrefetcher::makeKey( const AsciiString& filename )
+{
+	AsciiString key = filename;
+	key.toLower();
+
+	if (key.find('/') == NULL || key.getLength() >= _MAX_PATH)
+		return key;
+
+	char buffer[_MAX_PATH];
+	strcpy(buffer, key.str());
+	for (char *c = buffer; *c; ++c)
+	{
+		if (*c == '/')
+			*c = '\\';
+	}
+	key = buffer;
+	return key;
+}
+
+//============================================================================
+// FilePrefetcher::startThreads
+//============================================================================
+
+void FilePrefetcher::startThreads( void )
+{
+	for (Int i = 0; i < NumPrefetchThreads; ++i)
+	{
+		if (m_threads[i] == NULL)
+		{
+			m_threads[i] = NEW FilePrefetchThread(this);
+			m_threads[i]->Execute();
+		}
+	}
+}
+
+//============================================================================
+// FilePrefetcher::stopThreads
+//============================================================================
+
+void FilePrefetcher::stopThreads( void )
+{
+	for (Int i = 0; i < NumPrefetchThreads; ++i)
+	{
+		if (m_threads[i] != NULL)
+		{
+			// the new thread sets 'running' itself, so if we stopped it before it got that far it
+			// would never see the stop, and Stop() would end up killing it.
+			while (m_threads[i]->Is_Running() && !m_threads[i]->hasStarted())
+				Sleep(0);
+
+			// the destructor stops the thread, letting it finish the read it's on.
+			delete m_threads[i];
+			m_threads[i] = NULL;
+		}
+	}
+}
+
+//============================================================================
+// FilePrefetcher::submit
+//============================================================================
+
+void FilePrefetcher::submit( const AsciiString& filename, Bool decompress )
+{
+	if (filename.isEmpty())
+		return;
+
+	// local files win in openFile, and there's nothing to gain reading ahead anything else.
+	if (TheLocalFileSystem->doesFileExist(filename.str()) || !TheArchiveFileSystem->doesFileExist(filename.str()))
+		return;
+
+	Request request;
+	request.m_key = makeKey(filename);
+	request.m_filename = filename;
+	request.m_decompress = decompress;
+
+	{
+		CriticalSectionClass::LockClass lock(m_lock);
+
+		if (m_entries.find(request.m_key) != m_entries.end())
+			return;
+
+		Entry &entry = m_entries[request.m_key];
+		entry.m_state = PREFETCH_PENDING;
+		entry.m_data = NULL;
+		entry.m_size = 0;
+		entry.m_decompressed = FALSE;
+
+		m_requests.push_back(request);
+	}
+
+	startThreads();
+}
+
+//============================================================================
+// FilePrefetcher::flush
+//============================================================================
+
+void FilePrefetcher::flush( void )
+{
+	stopThreads();
+
+	CriticalSectionClass::LockClass lock(m_lock);
+
+	for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if (it->second.m_state == PREFETCH_READY)
+		{
+			delete [] it->second.m_data;
+			++m_wasted;
+		}
+	}
+
+	if (m_hits || m_misses || m_wasted)
+	{
+		DEBUG_LOG(("FilePrefetcher - %d hits, %d misses, %d wasted, %d bytes prefetched\n", m_hits, m_misses, m_wasted, m_bytesPrefetched));
+	}
+
+	m_entries.clear();
+	m_requests.clear();
+	m_cachedBytes = 0;
+	++m_generation;
+
+	m_hits = 0;
+	m_misses = 0;
+	m_wasted = 0;
+	m_bytesPrefetched = 0;
+}
+
+//============================================================================
+// FilePrefetcher::take
+//============================================================================
+
+Bool FilePrefetcher::take( const AsciiString& filename, Bool decompressed, char *&data, Int &size )
+{
+	CriticalSectionClass::LockClass lock(m_lock);
+
+	// the usual case once a load is over, don't bother building a key.
+	if (m_entries.empty())
+		return FALSE;
+
+	EntryMap::iterator it = m_entries.find(makeKey(filename));
+	if (it == m_entries.end())
+		return FALSE;
+
+	Entry &entry = it->second;
+	if (entry.m_state == PREFETCH_PENDING)
+	{
+		// too late, whoever asked will read it themselves.  dropping the entry makes the
+		// worker throw its copy away, and takes the request out of the queue if it's still there.
+		++m_misses;
+		m_entries.erase(it);
+		return FALSE;
+	}
+
+	if (entry.m_decompressed && !decompressed)
+		return FALSE;
+
+	data = entry.m_data;
+	size = entry.m_size;
+	m_cachedBytes -= entry.m_size;
+	++m_hits;
+	m_entries.erase(it);
+
+	return TRUE;
+}
+
+//============================================================================
+// FilePrefetcher::processRequest
+//============================================================================
+
+Bool FilePrefetcher::processRequest( void )
+{
+	Request request;
+	UnsignedInt generation;
+
+	{
+		CriticalSectionClass::LockClass lock(m_lock);
+
+		if (m_requests.empty() || (m_cachedBytes >= MaxPrefetchBytes))
+			return FALSE;
+
+		request = m_requests.front();
+		m_requests.pop_front();
+		generation = m_generation;
+
+		// taken (and missed) while it was still queued.
+		if (m_entries.find(request.m_key) == m_entries.end())
+			return TRUE;
+	}
+
+	char *data = NULL;
+	Int size = 0;
+	Bool decompressed = FALSE;
+
+	File *file = TheArchiveFileSystem->openFile(request.m_filename.str(), File::READ | File::BINARY);
+	if (file != NULL)
+	{
+		size = file->size();
+		data = file->readEntireAndClose();
+		file = NULL;
+	}
+
+	if (data != NULL && request.m_decompress && CompressionManager::isDataCompressed(data, size))
+	{
+		Int uncompLen = CompressionManager::getUncompressedSize(data, size);
+		char *uncompBuffer = NEW char[uncompLen];
+		if (CompressionManager::decompressData(data, size, uncompBuffer, uncompLen) == uncompLen)
+		{
+			delete [] data;
+			data = uncompBuffer;
+			size = uncompLen;
+			decompressed = TRUE;
+		}
+		else
+		{
+			// leave it for the reader to sort out, same as CachedFileInputStream does.
+			delete [] uncompBuffer;
+		}
+	}
+
+	CriticalSectionClass::LockClass lock(m_lock);
+
+	EntryMap::iterator it = m_entries.find(request.m_key);
+	if (generation != m_generation || it == m_entries.end() || it->second.m_state != PREFETCH_PENDING)
+	{
+		if (data != NULL)
+		{
+			delete [] data;
+			++m_wasted;
+		}
+		return TRUE;
+	}
+
+	if (data == NULL)
+	{
+		m_entries.erase(it);
+		return TRUE;
+	}
+
+	it->second.m_state = PREFETCH_READY;
+	it->second.m_data = data;
+	it->second.m_size = size;
+	it->second.m_decompressed = decompressed;
+	m_cachedBytes += size;
+	m_bytesPrefetched += size;
+
+	return TRUE;
+}
+
 //============================================================================
 // FileSystem::FileSystem
 //============================================================================
 
-FileSystem::FileSystem()
+FileSystem::FileSystem() :
+	m_prefetcher(NULL)
 {
 
 }
@@ -132,7 +527,11 @@ FileSystem::FileSystem()
 
 FileSystem::~FileSystem()
 {
-
+	if (m_prefetcher != NULL)
+	{
+		delete m_prefetcher;
+		m_prefetcher = NULL;
+	}
 }
 
 //============================================================================
@@ -163,6 +562,7 @@ void		FileSystem::update( void )
 void		FileSystem::reset( void )
 {
 	USE_PERF_TIMER(FileSystem)
+	flushPrefetches();
 	TheLocalFileSystem->reset();
 	TheArchiveFileSystem->reset();
 }
@@ -181,6 +581,28 @@ File*		FileSystem::openFile( const Char *filename, Int access )
 		file = TheLocalFileSystem->openFile( filename, access );
 	}
 
+	// archive files come back read only no matter what access asked for, so a
+	// prefetched buffer is exactly what the archive would have handed out.
+	if ( (m_prefetcher != NULL) && (file == NULL) )
+	{
+		char *data = NULL;
+		Int size = 0;
+		if (m_prefetcher->take( AsciiString(filename), FALSE, data, size ))
+		{
+			RAMFile *ramFile = newInstance( RAMFile );
+			ramFile->deleteOnClose();
+			if (ramFile->openFromBuffer( data, size, AsciiString(filename) ))
+			{
+				file = ramFile;
+			}
+			else
+			{
+				delete [] data;
+				ramFile->deleteInstance();
+			}
+		}
+	}
+
 	if ( (TheArchiveFileSystem != NULL) && (file == NULL) )
 	{
 		file = TheArchiveFileSystem->openFile( filename );
@@ -189,6 +611,54 @@ File*		FileSystem::openFile( const Char *filename, Int access )
 	return file;
 }
 
+//============================================================================
+// FileSystem::prefetchFiles
+//============================================================================
+/**
+	* Start reading the given archived files in the background.  Anything that
+	* isn't in an archive (or is overridden by a local file) is ignored.  Call
+	* flushPrefetches once the files have been used, to free whatever wasn't.
+	*/
+void FileSystem::prefetchFiles( const PrefetchFileList& filenames, Bool decompress )
+{
+	if ( (TheLocalFileSystem == NULL) || (TheArchiveFileSystem == NULL) )
+		return;
+
+	if (m_prefetcher == NULL)
+		m_prefetcher = NEW FilePrefetcher;
+
+	for (PrefetchFileList::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+	{
+		m_prefetcher->submit( *it, decompress );
+	}
+}
+
+//============================================================================
+// FileSystem::flushPrefetches
+//============================================================================
+
+void FileSystem::flushPrefetches( void )
+{
+	if (m_prefetcher != NULL)
+		m_prefetcher->flush();
+}
+
+//============================================================================
+// FileSystem::takePrefetchedData
+//============================================================================
+
+Bool FileSystem::takePrefetchedData( const Char *filename, Bool decompressed, char *&data, Int &size )
+{
+	if (m_prefetcher == NULL)
+		return FALSE;
+
+	// openFile would pick a local file over the archive, so don't hand out the archive's copy.
+	if ( (TheLocalFileSystem != NULL) && TheLocalFileSystem->doesFileExist( filename ) )
+		return FALSE;
+
+	return m_prefetcher->take( AsciiString(filename), decompressed, data, size );
+}
+
 //============================================================================
 // FileSystem::doesFileExist
 //============================================================================
@@ -304,6 +774,9 @@ void FileSystem::loadMusicFilesFromCD()
 		return;
 	}
 
+	// the prefetch threads read the archive map without a lock.
+	flushPrefetches();
+
 	AsciiString cdRoot;
 	Int dc = TheCDManager->driveCount();
 	for (Int i = 0; i < dc; ++i) {
@@ -328,5 +801,6 @@ void FileSystem::unloadMusicFilesFromCD()
 		return;
 	}
 
+	flushPrefetches();
 	TheArchiveFileSystem->closeArchiveFile( MUSIC_BIG );
 }
@@ -199,6 +199,35 @@ DECLARE_PERF_TIMER(MemoryPoolInitFilling)
 static Bool thePreMainInitFlag = false;
 static Bool theMainInitFlag = false;
 
+#ifdef MEMORYPOOL_MAGAZINES
+
+enum
+{
+	MAX_MAGAZINE_POOLS = 1024,						///< pools created after this many just don't get magazines
+	MAGAZINE_SIZE = 32,										///< max blocks cached per thread per pool
+	MAGAZINE_BATCH = MAGAZINE_SIZE / 2		///< blocks moved to/from the blobs per refill/spill
+};
+
+/**
+	A magazine is a small per-thread stack of free blocks for a single pool. MemoryPool
+	serves allocations and frees from the calling thread's magazine without taking
+	TheMemoryPoolCriticalSection; the lock is only taken to refill an empty magazine or
+	to spill a full one, a whole batch of blocks at a time. Blocks sitting in a magazine
+	are still counted as used by their blob and pool.
+*/
+struct MemoryPoolMagazine
+{
+	Int										m_count;										///< number of valid entries in m_blocks
+	UnsignedInt						m_generation;								///< the pool's m_magazineGeneration when this was last filled
+	MemoryPoolSingleBlock	*m_blocks[MAGAZINE_SIZE];		///< free blocks, most recently freed last
+};
+
+static MemoryPool *theMagazinePools[MAX_MAGAZINE_POOLS];			///< slot -> pool (null once the pool is destroyed)
+static Int theNextMagazineSlot = 0;
+static __declspec(thread) MemoryPoolMagazine **theThreadMagazines = NULL;	///< this thread's magazines, indexed by slot
+
+#endif
+
 // ----------------------------------------------------------------------------
 // PRIVATE PROTOTYPES 
 // ----------------------------------------------------------------------------
@@ -473,6 +502,8 @@ private:
 	MemoryPool							*m_owningPool;				///< the pool that owns this blob
 	MemoryPoolBlob					*m_nextBlob;					///< next blob in this pool
 	MemoryPoolBlob					*m_prevBlob;					///< prev blob in this pool
+	MemoryPoolBlob					*m_nextFreeBlob;			///< next blob in this pool that has free blocks
+	MemoryPoolBlob					*m_prevFreeBlob;			///< prev blob in this pool that has free blocks
 	MemoryPoolSingleBlock		*m_firstFreeBlock;		///< ptr to first available block in this blob
 	Int											m_usedBlocksInBlob;		///< total allocated blocks in this blob
 	Int											m_totalBlocksInBlob;	///< total blocks in this blob (allocated + available)
@@ -487,6 +518,8 @@ public:
 
 	void addBlobToList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
 	void removeBlobFromList(MemoryPoolBlob **ppHead, MemoryPoolBlob **ppTail);
+	void addBlobToFreeList(MemoryPoolBlob **ppHead);
+	void removeBlobFromFreeList(MemoryPoolBlob **ppHead);
 	MemoryPoolBlob *getNextInList();
 	Bool hasAnyFreeBlocks();
 
@@ -1156,6 +1189,8 @@ MemoryPoolBlob::MemoryPoolBlob() :
 	m_owningPool(NULL),
 	m_nextBlob(NULL),
 	m_prevBlob(NULL),
+	m_nextFreeBlob(NULL),
+	m_prevFreeBlob(NULL),
 	m_firstFreeBlock(NULL),
 	m_usedBlocksInBlob(0),
 	m_totalBlocksInBlob(0),
@@ -1247,6 +1282,40 @@ void MemoryPoolBlob::removeBlobFromList(MemoryPoolBlob **ppHead, MemoryPoolBlob
 		this->m_nextBlob->m_prevBlob = this->m_prevBlob;
 }
 
+//-----------------------------------------------------------------------------
+/**
+	add this blob to the head of a given pool's list-of-blobs-with-free-blocks.
+	a blob should be in that list exactly when hasAnyFreeBlocks() is true.
+*/
+void MemoryPoolBlob::addBlobToFreeList(MemoryPoolBlob **ppHead)
+{
+	m_prevFreeBlob = NULL;
+	m_nextFreeBlob = *ppHead;
+
+	if (*ppHead != NULL)
+		(*ppHead)->m_prevFreeBlob = this;
+
+	*ppHead = this;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	remove this blob from a given pool's list-of-blobs-with-free-blocks
+*/
+void MemoryPoolBlob::removeBlobFromFreeList(MemoryPoolBlob **ppHead)
+{
+	if (*ppHead == this)
+		*ppHead = m_nextFreeBlob;
+	else
+		m_prevFreeBlob->m_nextFreeBlob = m_nextFreeBlob;
+
+	if (m_nextFreeBlob != NULL)
+		m_nextFreeBlob->m_prevFreeBlob = m_prevFreeBlob;
+
+	m_nextFreeBlob = NULL;
+	m_prevFreeBlob = NULL;
+}
+
 //-----------------------------------------------------------------------------
 /**
 	grab a free block from this blob, mark it as taken, and return it.
@@ -1510,6 +1579,10 @@ MemoryPool::MemoryPool() :
 	m_lastBlob(NULL),
 	m_firstBlobWithFreeBlocks(NULL)
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	m_magazineSlot = -1;
+	m_magazineGeneration = 0;
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -1531,6 +1604,20 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 	m_lastBlob = NULL;
 	m_firstBlobWithFreeBlocks = NULL;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// pools that aren't allowed to grow don't get magazines, since blocks cached by
+	// one thread could make another thread run out.
+	if (m_magazineSlot < 0 && m_overflowAllocationCount > 0)
+	{
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		if (theNextMagazineSlot < MAX_MAGAZINE_POOLS)
+		{
+			m_magazineSlot = theNextMagazineSlot++;
+			theMagazinePools[m_magazineSlot] = this;
+		}
+	}
+#endif
+
 	// go ahead and init the initial block here (will throw on failure)
 	createBlob(m_initialAllocationCount);
 }
@@ -1541,6 +1628,15 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 */
 MemoryPool::~MemoryPool()
 {   
+#ifdef MEMORYPOOL_MAGAZINES
+	// any magazines still holding our blocks are simply abandoned; the slot is never reused.
+	if (m_magazineSlot >= 0)
+	{
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		theMagazinePools[m_magazineSlot] = NULL;
+	}
+#endif
+
 	// toss everything. we could do this slightly more efficiently,
 	// but not really worth the extra code to do so.
 	while (m_firstBlob) 
@@ -1566,7 +1662,7 @@ MemoryPoolBlob* MemoryPool::createBlob(Int allocationCount)
 	blob->addBlobToList(&m_firstBlob, &m_lastBlob);
 
 	DEBUG_ASSERTCRASH(m_firstBlobWithFreeBlocks == NULL, ("DO NOT IGNORE. Please call John McD - x36872 (m_firstBlobWithFreeBlocks != NULL)"));
-	m_firstBlobWithFreeBlocks = blob;
+	blob->addBlobToFreeList(&m_firstBlobWithFreeBlocks);
 
 	// bookkeeping
 	m_totalBlocksInPool += allocationCount;
@@ -1599,10 +1695,8 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 	// de-link it from our list
 	blob->removeBlobFromList(&m_firstBlob, &m_lastBlob);
 	
-	// ensure that the 'first free' blob is still a valid blob. 
-	// (doesn't need to actually have free blocks, just be a valid blob) 
-	if (m_firstBlobWithFreeBlocks == blob)
-		m_firstBlobWithFreeBlocks = m_firstBlob;
+	if (blob->hasAnyFreeBlocks())
+		blob->removeBlobFromFreeList(&m_firstBlobWithFreeBlocks);
 
 	// this is evil... since there is no 'placement delete' we must do this the hard way
 	// and call the dtor directly. ordinarily this is heinous, but in this case we'll
@@ -1623,32 +1717,14 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 
 //-----------------------------------------------------------------------------
 /**
-	allocate a block from this pool and return it, but don't bother zeroing
-	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
-	function will never return null.
+	take a free block from the blobs, creating an overflow blob if none of them
+	have any space left. the caller must hold TheMemoryPoolCriticalSection. if 
+	unable to allocate, throw ERROR_OUT_OF_MEMORY. this function will never return null.
 */
-void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+MemoryPoolSingleBlock* MemoryPool::takeBlockFromBlobs(DECLARE_LITERALSTRING_ARG1)
 {
-	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
-
-	if (m_firstBlobWithFreeBlocks != NULL && !m_firstBlobWithFreeBlocks->hasAnyFreeBlocks()) 
-	{
-		// hmm... the current 'free' blob has nothing available. look and see if there
-		// are any other existing blobs with freespace.
-		MemoryPoolBlob* blob = m_firstBlob;
-		for (; blob != NULL; blob = blob->getNextInList()) 
-		{
-			if (blob->hasAnyFreeBlocks())
-			 	break;
-		}
-
-		// note that if we walk thru the list without finding anything, this will 
-		// reset m_firstBlobWithFreeBlocks to null and fall thru.
-	 	m_firstBlobWithFreeBlocks = blob;
-	}
-	
-	// OK, if we are here then we have no blobs with freespace... darn.
-	// allocate an overflow block.
+	// m_firstBlobWithFreeBlocks heads the list of blobs that have free blocks, so if it's
+	// null, we have no blobs with freespace... darn. allocate an overflow block.
 	if (m_firstBlobWithFreeBlocks == NULL) 
 	{
 		if (m_overflowAllocationCount == 0)
@@ -1668,17 +1744,173 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 	MemoryPoolSingleBlock *block = blob->allocateSingleBlock(PASS_LITERALSTRING_ARG1);
 	DEBUG_ASSERTCRASH(block, ("should not fail here"));
 
-#ifdef MEMORYPOOL_CHECKPOINTING
-	BlockCheckpointInfo *bi = debugAddCheckpointInfo(block->debugGetLiteralTagString(), m_factory->getCurCheckpoint(), getAllocationSize());
-	if (bi)
-		block->debugSetCheckpointInfo(bi);
-#endif
+	if (!blob->hasAnyFreeBlocks())
+		blob->removeBlobFromFreeList(&m_firstBlobWithFreeBlocks);
 
 	// bookkeeping
 	++m_usedBlocksInPool;
 	if (m_peakUsedBlocksInPool < m_usedBlocksInPool)
 		m_peakUsedBlocksInPool = m_usedBlocksInPool;
 
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give a block back to the blob that owns it. the caller must hold 
+	TheMemoryPoolCriticalSection.
+*/
+void MemoryPool::returnBlockToBlob(MemoryPoolSingleBlock *block)
+{
+	MemoryPoolBlob *blob = block->getOwningBlob();
+	
+	DEBUG_ASSERTCRASH(blob && blob->getOwningPool() == this, ("block does not belong to this pool"));
+
+	Bool wasFull = !blob->hasAnyFreeBlocks();
+
+	blob->freeSingleBlock(block);
+	
+	if (wasFull)
+		blob->addBlobToFreeList(&m_firstBlobWithFreeBlocks);
+
+	// bookkeeping
+	--m_usedBlocksInPool;
+
+	// normally we keep empty blobs around, but if asked to, give empty overflow blobs
+	// back to the system as soon as they empty out. (the first blob is always kept.)
+	if (blob->getUsedBlockCount() == 0 && blob != m_firstBlob && m_factory->getReleaseEmptyOverflowBlobs())
+	{
+		freeBlob(blob);
+	}
+}
+
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/**
+	return the calling thread's magazine for this pool, creating it if necessary.
+	returns null if this pool doesn't use magazines.
+*/
+MemoryPoolMagazine* MemoryPool::getThreadMagazine()
+{
+	if (m_magazineSlot < 0)
+		return NULL;
+
+	MemoryPoolMagazine **mags = theThreadMagazines;
+	if (mags == NULL)
+	{
+		mags = (MemoryPoolMagazine **)::sysAllocateDoNotZero(MAX_MAGAZINE_POOLS * sizeof(MemoryPoolMagazine *));	// will throw on failure
+		memset(mags, 0, MAX_MAGAZINE_POOLS * sizeof(MemoryPoolMagazine *));
+		theThreadMagazines = mags;
+	}
+
+	MemoryPoolMagazine *mag = mags[m_magazineSlot];
+	if (mag == NULL)
+	{
+		mag = (MemoryPoolMagazine *)::sysAllocateDoNotZero(sizeof(MemoryPoolMagazine));	// will throw on failure
+		mag->m_count = 0;
+		mag->m_generation = m_magazineGeneration;
+		mags[m_magazineSlot] = mag;
+	}
+	else if (mag->m_generation != m_magazineGeneration)
+	{
+		// the pool was reset since we filled this, so the blocks in it no longer exist.
+		mag->m_count = 0;
+		mag->m_generation = m_magazineGeneration;
+	}
+	return mag;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	move a batch of blocks from the blobs into an empty magazine. only the first
+	block is allowed to grow the pool (and throws if it can't); the rest are only
+	taken if they are already free, so caching never makes a pool bigger by itself.
+*/
+void MemoryPool::refillMagazine(MemoryPoolMagazine *mag)
+{
+	DEBUG_ASSERTCRASH(mag->m_count == 0, ("refilling a nonempty magazine"));
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	mag->m_blocks[mag->m_count++] = takeBlockFromBlobs();	// throws on failure
+	while (mag->m_count < MAGAZINE_BATCH && m_usedBlocksInPool < m_totalBlocksInPool)
+	{
+		mag->m_blocks[mag->m_count++] = takeBlockFromBlobs();
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give the oldest 'count' blocks in the magazine back to their blobs, and slide
+	the rest down.
+*/
+void MemoryPool::spillMagazine(MemoryPoolMagazine *mag, Int count)
+{
+	DEBUG_ASSERTCRASH(count >= 0 && count <= mag->m_count, ("bad spill count"));
+
+	{
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		for (Int i = 0; i < count; ++i)
+			returnBlockToBlob(mag->m_blocks[i]);
+	}
+
+	mag->m_count -= count;
+	for (Int j = 0; j < mag->m_count; ++j)
+		mag->m_blocks[j] = mag->m_blocks[j + count];
+}
+#endif
+
+//-----------------------------------------------------------------------------
+/**
+	give the calling thread's cached blocks for this pool back to the pool, so
+	that they can be used by other threads (or their blobs released).
+*/
+void MemoryPool::releaseThreadMagazine()
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	if (m_magazineSlot < 0 || theThreadMagazines == NULL)
+		return;
+
+	MemoryPoolMagazine *mag = theThreadMagazines[m_magazineSlot];
+	if (mag == NULL)
+		return;
+
+	if (mag->m_generation == m_magazineGeneration)
+		spillMagazine(mag, mag->m_count);
+	
+	theThreadMagazines[m_magazineSlot] = NULL;
+	::sysFree((void *)mag);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/**
+	allocate a block from this pool and return it, but don't bother zeroing
+	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
+	function will never return null.
+*/
+void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *mag = getThreadMagazine();
+	if (mag)
+	{
+		if (mag->m_count == 0)
+			refillMagazine(mag);	// throws on failure
+		return mag->m_blocks[--mag->m_count]->getUserData();
+	}
+#endif
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	MemoryPoolSingleBlock *block = takeBlockFromBlobs(PASS_LITERALSTRING_ARG1);	// throws on failure
+
+#ifdef MEMORYPOOL_CHECKPOINTING
+	BlockCheckpointInfo *bi = debugAddCheckpointInfo(block->debugGetLiteralTagString(), m_factory->getCurCheckpoint(), getAllocationSize());
+	if (bi)
+		block->debugSetCheckpointInfo(bi);
+#endif
+
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(debugLiteralTagString, 1*getAllocationSize(), 0);
 	#ifdef USE_FILLER_VALUE
@@ -1714,15 +1946,25 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;	// my, that was easy
 
+	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine *mag = getThreadMagazine();
+	if (mag)
+	{
+		DEBUG_ASSERTCRASH(block->getOwningBlob() && block->getOwningBlob()->getOwningPool() == this, ("block does not belong to this pool"));
+		if (mag->m_count == MAGAZINE_SIZE)
+			spillMagazine(mag, MAGAZINE_BATCH);
+		mag->m_blocks[mag->m_count++] = block;
+		return;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
-	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
-	MemoryPoolBlob *blob = block->getOwningBlob();
 #ifdef MEMORYPOOL_DEBUG
 	const char* tagString = block->debugGetLiteralTagString();
 #endif
-	
-	DEBUG_ASSERTCRASH(blob && blob->getOwningPool() == this, ("block does not belong to this pool"));
 
 #ifdef MEMORYPOOL_CHECKPOINTING
 	BlockCheckpointInfo *bi = block->debugGetCheckpointInfo();
@@ -1731,22 +1973,7 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 		bi->debugSetFreepoint(m_factory->getCurCheckpoint());
 #endif
 
-	blob->freeSingleBlock(block);
-	
-	// if we want to free the blobs as they become empty, do that here.
-	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
-	//
-	// if (blob->m_usedBlocksInBlob == 0) 
-	// {
-	//	freeBlob(blob);
-	//	return;
-	//} 
-	
-	if (!m_firstBlobWithFreeBlocks)
-		m_firstBlobWithFreeBlocks = blob;
-
-	// bookkeeping
-	--m_usedBlocksInPool;
+	returnBlockToBlob(block);
 
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(tagString, -1*getAllocationSize(), 0);
@@ -1773,6 +2000,9 @@ Int MemoryPool::countBlobsInPool()
 */
 Int MemoryPool::releaseEmpties()
 {
+	// our own cached blocks would otherwise keep their blobs alive.
+	releaseThreadMagazine();
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
 	Int released = 0;
@@ -1796,6 +2026,11 @@ void MemoryPool::reset()
 {
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// any blocks cached by threads are about to go away with their blobs.
+	++m_magazineGeneration;
+#endif
+
 	// toss everything. we could do this slightly more efficiently,
 	// but not really worth the extra code to do so.
 	while (m_firstBlob) 
@@ -2007,7 +2242,9 @@ DynamicMemoryAllocator::DynamicMemoryAllocator() :
 	m_nextDmaInFactory(NULL),
 	m_numPools(0),
 	m_usedBlocksInDma(0),
-	m_rawBlocks(NULL)
+	m_rawBlocks(NULL),
+	m_poolForSizeClass(NULL),
+	m_largestPoolSize(-1)
 {
 	for (Int i = 0; i < MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS; i++)
 		m_pools[i] = 0;
@@ -2048,6 +2285,22 @@ void DynamicMemoryAllocator::init(MemoryPoolFactory *factory, Int numSubPools, c
 		DEBUG_ASSERTCRASH(i == 0 || pParms[i].allocationSize > pParms[i-1].allocationSize, ("alloc size must increase monotonically for DMA"));
 		m_pools[i] = m_factory->createMemoryPool(&pParms[i]);
 	}
+
+	// build the size-class table, so that findPoolForSize() is just a lookup. pool sizes
+	// are always a multiple of MEM_BOUND_ALIGNMENT, so one entry per step is exact.
+	if (m_numPools > 0)
+	{
+		m_largestPoolSize = m_pools[m_numPools-1]->getAllocationSize();
+		Int numSizeClasses = m_largestPoolSize/MEM_BOUND_ALIGNMENT + 1;
+		m_poolForSizeClass = (MemoryPool **)::sysAllocateDoNotZero(numSizeClasses * sizeof(MemoryPool *));	// throws on failure
+		Int pool = 0;
+		for (Int sizeClass = 0; sizeClass < numSizeClasses; ++sizeClass)
+		{
+			while (m_pools[pool]->getAllocationSize() < sizeClass*MEM_BOUND_ALIGNMENT)
+				++pool;
+			m_poolForSizeClass[sizeClass] = m_pools[pool];
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -2058,6 +2311,10 @@ DynamicMemoryAllocator::~DynamicMemoryAllocator()
 {
 	DEBUG_ASSERTCRASH(m_usedBlocksInDma == 0, ("destroying a nonempty dma"));
 
+	::sysFree((void *)m_poolForSizeClass);
+	m_poolForSizeClass = NULL;
+	m_largestPoolSize = -1;
+
 	/// @todo this may cause double-destruction of the subpools -- test & fix
 	for (Int i = 0; i < m_numPools; i++) 
 	{
@@ -2078,13 +2335,11 @@ DynamicMemoryAllocator::~DynamicMemoryAllocator()
 */
 MemoryPool *DynamicMemoryAllocator::findPoolForSize(Int allocSize)
 {
-	for (Int i = 0; i < m_numPools; i++)
-	{
-		DEBUG_ASSERTCRASH(m_pools[i], ("null pool"));
-		if (allocSize <= m_pools[i]->getAllocationSize())
-			return m_pools[i];
-	}
-	return NULL;
+	if (allocSize > m_largestPoolSize)
+		return NULL;
+	if (allocSize < 0)
+		allocSize = 0;
+	return m_poolForSizeClass[(allocSize + (MEM_BOUND_ALIGNMENT-1)) / MEM_BOUND_ALIGNMENT];
 }
 
 //-----------------------------------------------------------------------------
@@ -2581,7 +2836,8 @@ void DynamicMemoryAllocator::debugDmaInfoReport( FILE *fp )
 */
 MemoryPoolFactory::MemoryPoolFactory() :
 	m_firstPoolInFactory(NULL),
-	m_firstDmaInFactory(NULL)
+	m_firstDmaInFactory(NULL),
+	m_releaseEmptyOverflowBlobs(false)
 #ifdef MEMORYPOOL_CHECKPOINTING
 	, m_curCheckpoint(0)
 #endif
@@ -3523,6 +3779,8 @@ void shutdownMemoryManager()
 	}
 	else
 	{
+		releaseThreadMemoryPoolCaches();
+
 		if (TheDynamicMemoryAllocator)
 		{
 			DEBUG_ASSERTCRASH(TheMemoryPoolFactory, ("hmm, no factory"));
@@ -3551,6 +3809,45 @@ void shutdownMemoryManager()
 	theMainInitFlag = false;
 }
 
+//-----------------------------------------------------------------------------
+/**
+	give all of the calling thread's cached blocks back to their pools, and free
+	the thread's magazine table. it's fine to call this from a thread that has no
+	cache (or when magazines are disabled); it just does nothing.
+*/
+void releaseThreadMemoryPoolCaches()
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazine **mags = theThreadMagazines;
+	if (mags == NULL)
+		return;
+
+	for (Int i = 0; i < MAX_MAGAZINE_POOLS; ++i)
+	{
+		if (mags[i] == NULL)
+			continue;
+
+		// hold the lock until the blocks are back in the pool, so ~MemoryPool can't free
+		// the pool out from under us. (the lock is reentrant, spillMagazine takes it too.)
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		MemoryPool *pool = theMagazinePools[i];
+		if (pool)
+		{
+			pool->releaseThreadMagazine();	// also frees the magazine
+		}
+		else
+		{
+			// the pool is gone, and its blocks with it.
+			::sysFree((void *)mags[i]);
+			mags[i] = NULL;
+		}
+	}
+
+	theThreadMagazines = NULL;
+	::sysFree((void *)mags);
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void* createW3DMemPool(const char *poolName, int allocationSize)
 {
@@ -3583,3 +3880,9 @@ void freeFromW3DMemPool(void* pool, void* p)
 	DEBUG_ASSERTCRASH(pool, ("pool is null\n"));
 	((MemoryPool*)pool)->freeBlock(p);
 }
+
+//-----------------------------------------------------------------------------
+void releaseThreadW3DMemPoolCaches()
+{
+	releaseThreadMemoryPoolCaches();
+}
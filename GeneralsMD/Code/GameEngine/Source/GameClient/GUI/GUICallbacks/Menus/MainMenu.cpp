@@ -106,7 +106,9 @@ static NameKeyType campaignID = NAMEKEY_INVALID;
 static GameWindow *buttonCampaign = NULL;
 #ifdef TEST_COMPRESSION
 static GameWindow *buttonCompressTest = NULL;
+static GameWindow *buttonCompressBenchmark = NULL;
 void DoCompressTest( void );
+void DoCompressBenchmark( const AsciiString& corpusDir, const char *resultsFile );
 #endif // TEST_COMPRESSION
 #endif
 
@@ -566,6 +568,16 @@ void MainMenuInit( WindowLayout *layout, void *userData )
 																									 25, 175, 
 																									 400, 400, 
 																									 &instData, NULL, TRUE );
+
+	instData.init();
+	BitSet( instData.m_style, GWS_PUSH_BUTTON | GWS_MOUSE_TRACK );
+	instData.m_textLabelString = "Debug: Benchmark CompressCorpus";
+	instData.setTooltipText(UnicodeString(L"Only Used in Debug and Internal!"));
+	buttonCompressBenchmark = TheWindowManager->gogoGadgetPushButton( parentMainMenu, 
+																									 WIN_STATUS_ENABLED, 
+																									 25, 84, 
+																									 180, 26, 
+																									 &instData, NULL, TRUE );
 #endif // TEST_COMPRESSION
 
 	instData.init();
@@ -1321,6 +1333,10 @@ WindowMsgHandledType MainMenuSystem( GameWindow *window, UnsignedInt msg,
 			{
 				DoCompressTest();
 			}
+			else if( control == buttonCompressBenchmark )
+			{
+				DoCompressBenchmark("CompressCorpus\\", "AAACompressBenchmark.csv");
+			}
 #endif // TEST_COMPRESSION
 			else 
 #endif
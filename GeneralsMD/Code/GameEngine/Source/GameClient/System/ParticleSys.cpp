@@ -353,11 +353,60 @@ void Particle::applyForce( const Coord3D *force )
 	m_accel.z += force->z;
 }
 
+// ------------------------------------------------------------------------------------------------
+/** Return true if a particle with this shader, color and alpha is invisible.  colorKeyFrame is
+	* the frame of the color key the particle is heading for */
+// ------------------------------------------------------------------------------------------------
+static Bool isInvisibleWithShader( ParticleSystemInfo::ParticleShaderType shaderType, const RGBColor &color, 
+																	 Real alpha, UnsignedInt colorKeyFrame )
+{
+	switch (shaderType)
+	{
+		case ParticleSystemInfo::ADDITIVE:
+			// if color is black, this particle is invisible
+			
+			// check that we're not in the process of going to another color
+			if (colorKeyFrame == 0)
+			{
+				if ((color.red + color.green + color.blue) <= 0.06f)
+					return true;
+			}
+			return false;
+
+		case ParticleSystemInfo::ALPHA:
+			// if alpha is zero, this particle is invisible
+			if (alpha < 0.02f)
+				return true;
+			return false;
+
+		case ParticleSystemInfo::ALPHA_TEST:
+			// hmm... assume these particles are never invisible
+			return false;
+
+		case ParticleSystemInfo::MULTIPLY:
+			// if color is white, this particle is invisible
+
+			// check that we're not in the process of going to another color
+			if (colorKeyFrame == 0)
+			{
+				if ((color.red * color.green * color.blue) > 0.95f)
+					return true;
+			}
+			return false;
+	}
+
+	// should never get here - if we do, data is incorrect
+	return true;
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Update the behavior of an individual particle */
 // ------------------------------------------------------------------------------------------------
-Bool Particle::update( void )
+Bool Particle::update( const ParticleUpdateContext &ctx )
 {
+	// apply 'gravity' force
+	m_accel.z += ctx.m_gravity;
+
 	// integrate acceleration into velocity
 	m_vel.x += m_accel.x;
 	m_vel.y += m_accel.y;
@@ -368,17 +417,13 @@ Bool Particle::update( void )
 	m_vel.z *= m_velDamping;
 
 	// integrate velocity into position
-	const Coord3D *driftVel = m_system->getDriftVelocity();
-	m_pos.x += m_vel.x + driftVel->x;
-	m_pos.y += m_vel.y + driftVel->y;
-	m_pos.z += m_vel.z + driftVel->z;
+	m_pos.x += m_vel.x + ctx.m_driftVelocity.x;
+	m_pos.y += m_vel.y + ctx.m_driftVelocity.y;
+	m_pos.z += m_vel.z + ctx.m_driftVelocity.z;
 
 	// integrate the wind (if specified) into position
-	ParticleSystemInfo::WindMotion windMotion = m_system->getWindMotion();
-
-	// see if we should even do anything
-	if( windMotion != ParticleSystemInfo::WIND_MOTION_NOT_USED )
-		doWindMotion();
+	if( ctx.m_doWind )
+		doWindMotion( ctx );
 
 	// update orientation
 	m_angleZ += m_angularRateZ;
@@ -403,13 +448,13 @@ Bool Particle::update( void )
 	// Update alpha (if used)
 	//
 
-	if (m_system->getShaderType() != ParticleSystemInfo::ADDITIVE)
+	if (ctx.m_shaderType != ParticleSystemInfo::ADDITIVE)
 	{
 		m_alpha += m_alphaRate;
 
 		if (m_alphaTargetKey < MAX_KEYFRAMES && m_alphaKey[ m_alphaTargetKey ].frame)
 		{
-			if (TheGameClient->getFrame() - m_createTimestamp >= m_alphaKey[ m_alphaTargetKey ].frame)
+			if (ctx.m_frame - m_createTimestamp >= m_alphaKey[ m_alphaTargetKey ].frame)
 			{
 				m_alpha = m_alphaKey[ m_alphaTargetKey ].value;
 				m_alphaTargetKey++;
@@ -435,7 +480,7 @@ Bool Particle::update( void )
 
 	if (m_colorTargetKey < MAX_KEYFRAMES && m_colorKey[ m_colorTargetKey ].frame)
 	{
-		if (TheGameClient->getFrame() - m_createTimestamp >= m_colorKey[ m_colorTargetKey ].frame)
+		if (ctx.m_frame - m_createTimestamp >= m_colorKey[ m_colorTargetKey ].frame)
 		{
 			// can't set, because of colorscale
 			// m_color = m_colorKey[ m_colorTargetKey ].color;
@@ -481,7 +526,7 @@ Bool Particle::update( void )
 	DEBUG_ASSERTLOG( m_lifetimeLeft, ( "A particle has an infinite lifetime..." ));
 
 	// if we've gone totally invisible, destroy ourselves
-	if (isInvisible())
+	if (isInvisibleWithShader(ctx.m_shaderType, m_color, m_alpha, m_colorKey[ m_colorTargetKey ].frame))
 		return false;
 	return true;
 }
@@ -489,56 +534,19 @@ Bool Particle::update( void )
 // ------------------------------------------------------------------------------------------------
 /** Do wind motion as specified by the particle system template, if present */
 // ------------------------------------------------------------------------------------------------
-void Particle::doWindMotion( void )
+void Particle::doWindMotion( const ParticleUpdateContext &ctx )
 {
 
-	// get the angle of the wind
-	Real windAngle = m_system->getWindAngle();
-
-	// get the system position
-	Coord3D systemPos;
-	m_system->getPosition( &systemPos );
-
-	// when we're attached objects and drawables we offset by that position as well
-	if( ObjectID attachedObj = m_system->getAttachedObject() )
-	{
-		Object *obj = TheGameLogic->findObjectByID( attachedObj );
-
-		if( obj )
-		{
-			const Coord3D *objPos = obj->getPosition();
-
-			systemPos.x += objPos->x;
-			systemPos.y += objPos->y;
-			systemPos.z += objPos->z;
-
-		}  // end if
-
-	}  // end if
-	else if( DrawableID attachedDraw = m_system->getAttachedDrawable() )
-	{
-		Drawable *draw = TheGameClient->findDrawableByID( attachedDraw );
-
-		if( draw )
-		{
-			const Coord3D *drawPos = draw->getPosition();
-
-			systemPos.x += drawPos->x;
-			systemPos.y += drawPos->y;
-			systemPos.z += drawPos->z;
-
-		}  // end if
-
-	}  // end else if
-
 	//
 	// compute a vector from the system position in the world to the particle ... we will use
-	// this to compute how much force we apply
+	// this to compute how much force we apply.  The system position, including what it is
+	// attached to, and the wind angle are the same for every particle, so 
+	// ParticleSystem::fillUpdateContext works them out once.
 	//
 	Coord3D v;
-	v.x = m_pos.x - systemPos.x;
-	v.y = m_pos.y - systemPos.y;
-	v.z = m_pos.z - systemPos.z;
+	v.x = m_pos.x - ctx.m_windCenter.x;
+	v.y = m_pos.y - ctx.m_windCenter.y;
+	v.z = m_pos.z - ctx.m_windCenter.z;
 
 	// distance amounts for full force from wind and no force at all
 	Real fullForceDistance = 75.0f;
@@ -561,8 +569,8 @@ void Particle::doWindMotion( void )
 																		(noForceDistance - fullForceDistance)));
 
 		// integate the wind motion into the position
-		m_pos.x += (Cos( windAngle ) * windForceStrength);
-		m_pos.y += (Sin( windAngle ) * windForceStrength);
+		m_pos.x += (ctx.m_windCos * windForceStrength);
+		m_pos.y += (ctx.m_windSin * windForceStrength);
 
 	}  // end if
 
@@ -581,45 +589,10 @@ ParticlePriorityType Particle::getPriority( void )
 // ------------------------------------------------------------------------------------------------
 Bool Particle::isInvisible( void )
 {
-	switch (m_system->getShaderType())
-	{
-		case ParticleSystemInfo::ADDITIVE:
-			// if color is black, this particle is invisible
-			
-			// check that we're not in the process of going to another color
-			if (m_colorKey[ m_colorTargetKey ].frame == 0)
-			{
-				if ((m_color.red + m_color.green + m_color.blue) <= 0.06f)
-					return true;
-			}
-			return false;
-
-		case ParticleSystemInfo::ALPHA:
-			// if alpha is zero, this particle is invisible
-			if (m_alpha < 0.02f)
-				return true;
-			return false;
-
-		case ParticleSystemInfo::ALPHA_TEST:
-			// hmm... assume these particles are never invisible
-			return false;
-
-		case ParticleSystemInfo::MULTIPLY:
-			// if color is white, this particle is invisible
-
-			// check that we're not in the process of going to another color
-			if (m_colorKey[ m_colorTargetKey ].frame == 0)
-			{
-				if ((m_color.red * m_color.green * m_color.blue) > 0.95f)
-					return true;
-			}
-			return false;
-	}
-
-	// should never get here - if we do, data is incorrect
-	return true;
+	return isInvisibleWithShader(m_system->getShaderType(), m_color, m_alpha, m_colorKey[ m_colorTargetKey ].frame);
 }
 
+
 // ------------------------------------------------------------------------------------------------
 /** CRC */
 // ------------------------------------------------------------------------------------------------
@@ -1218,7 +1191,7 @@ ParticleSystem::~ParticleSystem()
 		m_systemParticlesHead->deleteInstance();
 
 	m_attachedToDrawableID = INVALID_DRAWABLE_ID;
-	m_attachedToObjectID = INVALID_ID;
+	setAttachedObjectID( INVALID_ID );
 
 	// if this system was controlled by a particle, detach
 	if (m_controlParticle)
@@ -1365,9 +1338,23 @@ void ParticleSystem::attachToDrawable( const Drawable *draw )
 void ParticleSystem::attachToObject( const Object *obj )
 {
 	if (obj)
-		m_attachedToObjectID = obj->getID();
+		setAttachedObjectID( obj->getID() );
 	else
-		m_attachedToObjectID = INVALID_ID;
+		setAttachedObjectID( INVALID_ID );
+}
+
+// ------------------------------------------------------------------------------------------------
+/** Change the attached object ID.  The manager indexes systems by the object they are attached
+	* to, so all changes after we've been added to it must go through here */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystem::setAttachedObjectID( ObjectID id )
+{
+	if (id == m_attachedToObjectID)
+		return;
+
+	ObjectID oldID = m_attachedToObjectID;
+	m_attachedToObjectID = id;
+	TheParticleSystemManager->friend_changeAttachedObject( this, oldID );
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1925,7 +1912,7 @@ Bool ParticleSystem::update( Int localPlayerIndex  )
 		else
 		{ 
 			// Drawable has been destroyed - lose our attachment to it
-			m_attachedToObjectID = INVALID_ID;
+			setAttachedObjectID( INVALID_ID );
 
 			// destroy ourselves
 			destroy();
@@ -2054,22 +2041,16 @@ Bool ParticleSystem::update( Int localPlayerIndex  )
 	//
 	// Update all particles in the system
 	//
+	ParticleUpdateContext ctx;
+	if (m_systemParticlesHead)
+		fillUpdateContext( &ctx );
+
 	Particle *p = m_systemParticlesHead;
 	Particle *oldParticle;
 	while (p)
 	{
 
-		// apply 'gravity' force
-		if (m_gravity != 0.0f)
-		{
-			Coord3D force;
-			force.x = 0.0f;
-			force.y = 0.0f;
-			force.z = m_gravity;
-			p->applyForce( &force );
-		}
-
-		if (p->update() == false)
+		if (p->update( ctx ) == false)
 		{
 			oldParticle = p;
 			p = p->m_systemNext;
@@ -2241,6 +2222,61 @@ void ParticleSystem::updateWindMotion( void )
 
 }  // end updateWindMotion
 
+// ------------------------------------------------------------------------------------------------
+/** Gather the values that every particle's update needs and that don't change while we update
+	* our particles */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystem::fillUpdateContext( ParticleUpdateContext *ctx )
+{
+
+	ctx->m_frame = TheGameClient->getFrame();
+	ctx->m_driftVelocity = m_driftVelocity;
+	ctx->m_gravity = m_gravity;
+	ctx->m_shaderType = m_shaderType;
+	ctx->m_doWind = (m_windMotion != ParticleSystemInfo::WIND_MOTION_NOT_USED);
+	if( ctx->m_doWind == FALSE )
+		return;
+
+	// the wind blows from the system position
+	getPosition( &ctx->m_windCenter );
+
+	// when we're attached objects and drawables we offset by that position as well
+	if( m_attachedToObjectID )
+	{
+		Object *obj = TheGameLogic->findObjectByID( m_attachedToObjectID );
+
+		if( obj )
+		{
+			const Coord3D *objPos = obj->getPosition();
+
+			ctx->m_windCenter.x += objPos->x;
+			ctx->m_windCenter.y += objPos->y;
+			ctx->m_windCenter.z += objPos->z;
+
+		}  // end if
+
+	}  // end if
+	else if( m_attachedToDrawableID )
+	{
+		Drawable *draw = TheGameClient->findDrawableByID( m_attachedToDrawableID );
+
+		if( draw )
+		{
+			const Coord3D *drawPos = draw->getPosition();
+
+			ctx->m_windCenter.x += drawPos->x;
+			ctx->m_windCenter.y += drawPos->y;
+			ctx->m_windCenter.z += drawPos->z;
+
+		}  // end if
+
+	}  // end else if
+
+	ctx->m_windCos = Cos( m_windAngle );
+	ctx->m_windSin = Sin( m_windAngle );
+
+}  // end fillUpdateContext
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 void ParticleSystem::addParticle( Particle *particleToAdd )
@@ -2414,13 +2450,18 @@ void ParticleSystem::xfer( Xfer *xfer )
 	ParticleSystemInfo::xfer( xfer );
 
 	// particle system ID
+	ParticleSystemID oldSystemID = m_systemID;
 	xfer->xferUser( &m_systemID, sizeof( ParticleSystemID ) );
+	if( m_systemID != oldSystemID )
+		TheParticleSystemManager->friend_changeParticleSystemID( this, oldSystemID );
 
 	// attached to drawable id
 	xfer->xferDrawableID( &m_attachedToDrawableID );
 
 	// attached to object id
-	xfer->xferObjectID( &m_attachedToObjectID );
+	ObjectID attachedToObjectID = m_attachedToObjectID;
+	xfer->xferObjectID( &attachedToObjectID );
+	setAttachedObjectID( attachedToObjectID );
 
 	// is local identity
 	xfer->xferBool( &m_isLocalIdentity );
@@ -2918,6 +2959,9 @@ void ParticleSystemManager::reset( void )
 	m_particleCount = 0;
 	m_fieldParticleCount = 0;
 	m_particleSystemCount = 0;
+	DEBUG_ASSERTCRASH( m_systemIDMap.empty() && m_attachedSystemMap.empty(), ("RESET: particle system indices aren't empty!\n") );
+	m_systemIDMap.clear();
+	m_attachedSystemMap.clear();
 
 	m_uniqueSystemID = INVALID_PARTICLE_SYSTEM_ID;
 	
@@ -3002,20 +3046,11 @@ ParticleSystem *ParticleSystemManager::findParticleSystem( ParticleSystemID id )
 	if (id == INVALID_PARTICLE_SYSTEM_ID)
 		return NULL;	// my, that was easy
 
-	ParticleSystem *system = NULL;
-
-	for( ParticleSystemListIt it = m_allParticleSystemList.begin(); it != m_allParticleSystemList.end(); ++it ) {
-		system = *it;
-		if (!system) {
-			continue;
-		}
-
-		if( system->getSystemID() == id ) {
-			return system;
-		}
-	}
+	ParticleSystemIDMap::iterator it = m_systemIDMap.find( id );
+	if( it == m_systemIDMap.end() )
+		return NULL;
 
-	return NULL;
+	return *it->second;
 
 }  // end findParticleSystem
 
@@ -3095,20 +3130,14 @@ void ParticleSystemManager::destroyAttachedSystems( Object *obj )
 	if( obj == NULL )
 		return;
 
-	// iterate through all systems
-	ParticleSystem *system = NULL;
-
-	for( ParticleSystemListIt it = m_allParticleSystemList.begin(); 
-			 it != m_allParticleSystemList.end(); 
-			 ++it ) 
+	// iterate through the systems attached to it.  destroy() only marks them, so this doesn't
+	// change the index out from under us
+	std::pair<AttachedSystemMap::iterator, AttachedSystemMap::iterator> range = m_attachedSystemMap.equal_range( obj->getID() );
+	for( AttachedSystemMap::iterator it = range.first; it != range.second; ++it )
 	{
 
-		system = *it;
-		if( system == NULL )
-			continue;
-		
-		if( system->getAttachedObject() == obj->getID() )
-			system->destroy();
+		DEBUG_ASSERTCRASH( it->second->getAttachedObject() == obj->getID(), ("destroyAttachedSystems: attached system index is stale\n") );
+		it->second->destroy();
 
 	}
 
@@ -3181,7 +3210,11 @@ void ParticleSystemManager::removeParticle( Particle *particleToRemove)
 // ------------------------------------------------------------------------------------------------
 void ParticleSystemManager::friend_addParticleSystem( ParticleSystem *particleSystemToAdd )
 {
-	m_allParticleSystemList.push_back(particleSystemToAdd);
+	ParticleSystemListIt it = m_allParticleSystemList.insert(m_allParticleSystemList.end(), particleSystemToAdd);
+	DEBUG_ASSERTCRASH(m_systemIDMap.find(particleSystemToAdd->getSystemID()) == m_systemIDMap.end(), ("Duplicate particle system ID %d\n", particleSystemToAdd->getSystemID()));
+	m_systemIDMap[ particleSystemToAdd->getSystemID() ] = it;
+	if (particleSystemToAdd->getAttachedObject() != INVALID_ID)
+		m_attachedSystemMap.insert(std::make_pair(particleSystemToAdd->getAttachedObject(), particleSystemToAdd));
 	++m_particleSystemCount;
 }
 
@@ -3190,14 +3223,52 @@ void ParticleSystemManager::friend_addParticleSystem( ParticleSystem *particleSy
 // ------------------------------------------------------------------------------------------------
 void ParticleSystemManager::friend_removeParticleSystem( ParticleSystem *particleSystemToRemove )
 {
-	ParticleSystemListIt it = std::find(m_allParticleSystemList.begin(), m_allParticleSystemList.end(), particleSystemToRemove);
-	if (it != m_allParticleSystemList.end()) {
-		m_allParticleSystemList.erase(it);
+	// the destructor has normally done this already
+	particleSystemToRemove->setAttachedObjectID( INVALID_ID );
+
+	ParticleSystemIDMap::iterator found = m_systemIDMap.find(particleSystemToRemove->getSystemID());
+	if (found != m_systemIDMap.end() && *found->second == particleSystemToRemove) {
+		m_allParticleSystemList.erase(found->second);
+		m_systemIDMap.erase(found);
 		--m_particleSystemCount;
 	}
 
 }
 
+// ------------------------------------------------------------------------------------------------
+/** A particle system's ID was changed (by loading a save game); re-index it. */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystemManager::friend_changeParticleSystemID( ParticleSystem *particleSystem, ParticleSystemID oldID )
+{
+	ParticleSystemIDMap::iterator found = m_systemIDMap.find(oldID);
+	if (found == m_systemIDMap.end() || *found->second != particleSystem) {
+		DEBUG_CRASH(("Particle system %d isn't indexed under its old ID %d\n", particleSystem->getSystemID(), oldID));
+		return;
+	}
+	ParticleSystemListIt it = found->second;
+	m_systemIDMap.erase(found);
+	DEBUG_ASSERTCRASH(m_systemIDMap.find(particleSystem->getSystemID()) == m_systemIDMap.end(), ("Duplicate particle system ID %d\n", particleSystem->getSystemID()));
+	m_systemIDMap[ particleSystem->getSystemID() ] = it;
+}
+
+// ------------------------------------------------------------------------------------------------
+/** A particle system's attached object changed; move it in the attached system index. */
+// ------------------------------------------------------------------------------------------------
+void ParticleSystemManager::friend_changeAttachedObject( ParticleSystem *particleSystem, ObjectID oldID )
+{
+	if (oldID != INVALID_ID) {
+		std::pair<AttachedSystemMap::iterator, AttachedSystemMap::iterator> range = m_attachedSystemMap.equal_range(oldID);
+		for (AttachedSystemMap::iterator it = range.first; it != range.second; ++it) {
+			if (it->second == particleSystem) {
+				m_attachedSystemMap.erase(it);
+				break;
+			}
+		}
+	}
+	if (particleSystem->getAttachedObject() != INVALID_ID)
+		m_attachedSystemMap.insert(std::make_pair(particleSystem->getAttachedObject(), particleSystem));
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Remove the oldest N number of particles from the lowest priority lists first.  We will
  * not remove particles from any priorities higher or equal to the priorityCap parameter. */
@@ -1104,6 +1104,9 @@ enum { PATHFIND_CELLS_PER_FRAME=5000}; // Number of cells we will search pathfin
 enum {CELL_INFOS_TO_ALLOCATE = 30000};
 PathfindCellInfo *PathfindCellInfo::s_infoArray = NULL;
 PathfindCellInfo *PathfindCellInfo::s_firstFree = NULL;						
+PathfindCellInfo **PathfindCellInfo::s_openHeap = NULL;
+Int PathfindCellInfo::s_openHeapCount = 0;
+UnsignedInt PathfindCellInfo::s_openSequence = 0;
 /**
  * Allocates a pool of pathfind cell infos.
  */
@@ -1111,6 +1114,10 @@ void PathfindCellInfo::allocateCellInfos(void)
 {
 	releaseCellInfos();
 	s_infoArray = new PathfindCellInfo[CELL_INFOS_TO_ALLOCATE];	// pool[]ify
+	// Every info can be on the open list at most once, so the heap never needs to grow.
+	s_openHeap = new PathfindCellInfo*[CELL_INFOS_TO_ALLOCATE];
+	s_openHeapCount = 0;
+	s_openSequence = 0;
 	s_infoArray[CELL_INFOS_TO_ALLOCATE-1].m_pathParent = NULL;
 	s_infoArray[CELL_INFOS_TO_ALLOCATE-1].m_isFree = true;
 	s_firstFree = s_infoArray;
@@ -1138,6 +1145,9 @@ void PathfindCellInfo::releaseCellInfos(void)
 	delete s_infoArray;
 	s_infoArray = NULL;
 	s_firstFree = NULL;
+	delete [] s_openHeap;
+	s_openHeap = NULL;
+	s_openHeapCount = 0;
 }
 
 /**
@@ -1155,6 +1165,8 @@ PathfindCellInfo *PathfindCellInfo::getACellInfo(PathfindCell *cell,const ICoord
 
 		info->m_nextOpen = NULL;
 		info->m_prevOpen = NULL;
+		info->m_openHeapIndex = -1;
+		info->m_openSequence = 0;
 		info->m_pathParent = NULL;
 		info->m_costSoFar = 0;		
 		info->m_totalCost = 0;
@@ -1184,6 +1196,89 @@ void PathfindCellInfo::releaseACellInfo(PathfindCellInfo *theInfo)
 	s_firstFree->m_isFree = true;
 }
 
+/**
+ * Moves the heap entry at ndx toward the root until its parent is not more expensive.
+ */
+void PathfindCellInfo::openHeapSiftUp(Int ndx) 
+{
+	PathfindCellInfo *theInfo = s_openHeap[ndx];
+	while (ndx > 0) {
+		Int parent = (ndx-1)>>1;
+		if (!openLess(theInfo, s_openHeap[parent])) {
+			break;
+		}
+		s_openHeap[ndx] = s_openHeap[parent];
+		s_openHeap[ndx]->m_openHeapIndex = ndx;
+		ndx = parent;
+	}
+	s_openHeap[ndx] = theInfo;
+	theInfo->m_openHeapIndex = ndx;
+}
+
+/**
+ * Moves the heap entry at ndx toward the leaves until neither child is cheaper.
+ */
+void PathfindCellInfo::openHeapSiftDown(Int ndx) 
+{
+	PathfindCellInfo *theInfo = s_openHeap[ndx];
+	for (;;) {
+		Int child = 2*ndx+1;
+		if (child >= s_openHeapCount) {
+			break;
+		}
+		if (child+1 < s_openHeapCount && openLess(s_openHeap[child+1], s_openHeap[child])) {
+			child++;
+		}
+		if (!openLess(s_openHeap[child], theInfo)) {
+			break;
+		}
+		s_openHeap[ndx] = s_openHeap[child];
+		s_openHeap[ndx]->m_openHeapIndex = ndx;
+		ndx = child;
+	}
+	s_openHeap[ndx] = theInfo;
+	theInfo->m_openHeapIndex = ndx;
+}
+
+/**
+ * Adds an info to the open heap.  The sequence number makes cells of equal cost come off
+ * in insertion order, exactly like the insertion sorted list this replaced, so paths (and CRCs) don't change.
+ */
+void PathfindCellInfo::openHeapPush(PathfindCellInfo *theInfo) 
+{
+	DEBUG_ASSERTCRASH(theInfo->m_openHeapIndex == -1, ("Already on open heap."));
+	DEBUG_ASSERTCRASH(s_openHeapCount < CELL_INFOS_TO_ALLOCATE, ("Open heap overflow."));
+	if (s_openHeapCount == 0) {
+		s_openSequence = 0;
+	}
+	theInfo->m_openSequence = s_openSequence++;
+	s_openHeap[s_openHeapCount] = theInfo;
+	s_openHeapCount++;
+	openHeapSiftUp(s_openHeapCount-1);
+}
+
+/**
+ * Removes an info from anywhere in the open heap.
+ */
+void PathfindCellInfo::openHeapRemove(PathfindCellInfo *theInfo) 
+{
+	Int ndx = theInfo->m_openHeapIndex;
+	DEBUG_ASSERTCRASH(ndx >= 0 && ndx < s_openHeapCount && s_openHeap[ndx] == theInfo, ("Not on open heap."));
+	theInfo->m_openHeapIndex = -1;
+	s_openHeapCount--;
+	if (ndx == s_openHeapCount) {
+		return;
+	}
+	// Move the last entry into the hole, and restore the heap in whichever direction it needs.
+	s_openHeap[ndx] = s_openHeap[s_openHeapCount];
+	s_openHeap[ndx]->m_openHeapIndex = ndx;
+	if (ndx > 0 && openLess(s_openHeap[ndx], s_openHeap[(ndx-1)>>1])) {
+		openHeapSiftUp(ndx);
+	}	else {
+		openHeapSiftDown(ndx);
+	}
+}
+
 //-----------------------------------------------------------------------------------
 
 /**
@@ -1236,6 +1331,7 @@ Bool PathfindCell::startPathfind( PathfindCell *goalCell  )
 	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
 	m_info->m_nextOpen = NULL;
 	m_info->m_prevOpen = NULL;
+	m_info->m_openHeapIndex = -1;
 	m_info->m_pathParent = NULL;
 	m_info->m_costSoFar = 0;		// start node, no cost to get here
 	m_info->m_totalCost = 0;
@@ -1307,11 +1403,11 @@ void PathfindCell::releaseInfo( void )
 	}
 
 	if (m_info) {
-		DEBUG_ASSERTCRASH(m_info->m_prevOpen==NULL && m_info->m_nextOpen==NULL, ("Shouldn't be linked."));
+		DEBUG_ASSERTCRASH(m_info->m_prevOpen==NULL && m_info->m_nextOpen==NULL && m_info->m_openHeapIndex==-1, ("Shouldn't be linked."));
 		DEBUG_ASSERTCRASH(m_info->m_open==NULL && m_info->m_closed==NULL, ("Shouldn't be linked."));
 		DEBUG_ASSERTCRASH(m_info->m_goalUnitID==INVALID_ID && m_info->m_posUnitID==INVALID_ID, ("Shouldn't be occupied."));
 		DEBUG_ASSERTCRASH(m_info->m_goalAircraftID==INVALID_ID , ("Shouldn't be occupied by aircraft."));
-		if (m_info->m_prevOpen || m_info->m_nextOpen || m_info->m_open || m_info->m_closed) {
+		if (m_info->m_prevOpen || m_info->m_nextOpen || m_info->m_openHeapIndex!=-1 || m_info->m_open || m_info->m_closed) {
 			// Bad release.  Skip for now, better leak than crash.  jba.
 			return;
 		}
@@ -1508,56 +1604,32 @@ Bool PathfindCell::removeObstacle( Object *obstacle )
 }
 
 /// put self on "open" list in ascending cost order, return new list
+/// The open list is a binary heap kept in PathfindCellInfo, list is always the cheapest cell on it.
 PathfindCell *PathfindCell::putOnSortedOpenList( PathfindCell *list )
 {
 	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
 	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==FALSE, ("Serious error - Invalid flags. jba"));
 	if (list == NULL)
 	{
-		list = this;
-		m_info->m_prevOpen = NULL;
-		m_info->m_nextOpen = NULL;
+		// Starting a new list.
+		PathfindCellInfo::s_openHeapCount = 0;
 	}
-	else
+	else if (list->m_info->m_openHeapIndex == -1)
 	{
-		// insertion sort
-		PathfindCell *c, *lastCell = NULL;
-		for( c = list; c; c = c->getNextOpen() )
-		{
-			if (c->m_info->m_totalCost > m_info->m_totalCost)
-				break;
-
-			lastCell = c;
-		}
-
-		if (c)
-		{
-			// insert just before "c"
-			if (c->m_info->m_prevOpen)
-				c->m_info->m_prevOpen->m_nextOpen = this->m_info;
-			else
-				list = this;
-
-			m_info->m_prevOpen = c->m_info->m_prevOpen;
-			c->m_info->m_prevOpen = this->m_info;
-				
-			m_info->m_nextOpen = c->m_info;
-
-		}
-		else
-		{
-			// append after "lastCell" - end of list
-			lastCell->m_info->m_nextOpen = this->m_info;
-			m_info->m_prevOpen = lastCell->m_info;
-			m_info->m_nextOpen = NULL;
-		}
+		// The start cell is made the list directly by startPathfind, so it isn't on the heap yet.
+		DEBUG_ASSERTCRASH(list->m_info->m_open, ("Serious error - Invalid flags. jba"));
+		PathfindCellInfo::s_openHeapCount = 0;
+		PathfindCellInfo::openHeapPush(list->m_info);
 	}
+	m_info->m_prevOpen = NULL;
+	m_info->m_nextOpen = NULL;
+	PathfindCellInfo::openHeapPush(m_info);
 
 	// mark newCell as being on open list
 	m_info->m_open = true;
 	m_info->m_closed = false;
 
-	return list;
+	return PathfindCellInfo::s_openHeap[0]->m_cell;
 }
 
 /// remove self from "open" list
@@ -1565,37 +1637,43 @@ PathfindCell *PathfindCell::removeFromOpenList( PathfindCell *list )
 {
 	DEBUG_ASSERTCRASH(m_info, ("Has to have info."));
 	DEBUG_ASSERTCRASH(m_info->m_closed==FALSE && m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-	if (m_info->m_nextOpen)
-		m_info->m_nextOpen->m_prevOpen = m_info->m_prevOpen;
-	
-	if (m_info->m_prevOpen)
-		m_info->m_prevOpen->m_nextOpen = m_info->m_nextOpen;
+	if (m_info->m_openHeapIndex != -1)
+	{
+		PathfindCellInfo::openHeapRemove(m_info);
+	}
 	else
-		list = getNextOpen();
+	{
+		// Start cell that was never put on the heap - it was the whole list.
+		DEBUG_ASSERTCRASH(list == this, ("Serious error - not on open list. jba"));
+		PathfindCellInfo::s_openHeapCount = 0;
+	}
 
 	m_info->m_open = false;
 	m_info->m_nextOpen = NULL;
 	m_info->m_prevOpen = NULL;
 
-	return list;
+	if (PathfindCellInfo::s_openHeapCount == 0)
+		return NULL;
+	return PathfindCellInfo::s_openHeap[0]->m_cell;
 }
 
 /// remove all cells from "open" list
 Int PathfindCell::releaseOpenList( PathfindCell *list )
 {
 	Int count = 0;
-	while (list) {
+	if (list && list->m_info->m_openHeapIndex == -1) {
+		// Start cell that was never put on the heap.
+		PathfindCellInfo::s_openHeapCount = 0;
+		PathfindCellInfo::openHeapPush(list->m_info);
+	}
+	while (PathfindCellInfo::s_openHeapCount > 0) {
 		count++;
-		DEBUG_ASSERTCRASH(list->m_info, ("Has to have info."));
-		DEBUG_ASSERTCRASH(list->m_info->m_closed==FALSE && list->m_info->m_open==TRUE, ("Serious error - Invalid flags. jba"));
-		PathfindCell *cur = list;
-		PathfindCellInfo *curInfo = list->m_info;
-		if (curInfo->m_nextOpen) {
-			list = curInfo->m_nextOpen->m_cell;
-		}	else {
-			list = NULL;
-		}
-		DEBUG_ASSERTCRASH(cur == curInfo->m_cell, ("Bad backpointer in PathfindCellInfo"));
+		PathfindCellInfo::s_openHeapCount--;
+		PathfindCellInfo *curInfo = PathfindCellInfo::s_openHeap[PathfindCellInfo::s_openHeapCount];
+		PathfindCell *cur = curInfo->m_cell;
+		DEBUG_ASSERTCRASH(cur->m_info == curInfo, ("Bad backpointer in PathfindCellInfo"));
+		DEBUG_ASSERTCRASH(curInfo->m_closed==FALSE && curInfo->m_open==TRUE, ("Serious error - Invalid flags. jba"));
+		curInfo->m_openHeapIndex = -1;
 		curInfo->m_nextOpen = NULL;
 		curInfo->m_prevOpen = NULL;
 		curInfo->m_open = FALSE;
@@ -1604,6 +1682,19 @@ Int PathfindCell::releaseOpenList( PathfindCell *list )
 	return count;
 }
 
+/// number of cells on the "open" list
+Int PathfindCell::getOpenListCount( void )
+{
+	return PathfindCellInfo::s_openHeapCount;
+}
+
+/// cell on the "open" list, in heap order
+PathfindCell *PathfindCell::getOpenListCell( Int ndx )
+{
+	DEBUG_ASSERTCRASH(ndx >= 0 && ndx < PathfindCellInfo::s_openHeapCount, ("Bad open list index."));
+	return PathfindCellInfo::s_openHeap[ndx]->m_cell;
+}
+
 /// remove all cells from "closed" list
 Int PathfindCell::releaseClosedList( PathfindCell *list )
 {
@@ -1869,68 +1960,101 @@ static void __fastcall resolveBlockZones(Int srcZone, Int targetZone, zoneStorag
 	}
 }
 
-static void __fastcall resolveZones(Int srcZone, Int targetZone, zoneStorageType *zoneEquivalency, Int sizeOfZE)
+/* Zone equivalency arrays are union-find forests.  The lowest zone in a set is always its root, 
+which gives the same zone numbering the old exhaustive merge did, without rescanning the whole
+array on every merge. */
+inline Int findZone(zoneStorageType *zoneEquivalency, Int zone)
 {
-	Int i;
-	// We have two zones being combined now. Keep the lower zone.
-	DEBUG_ASSERTCRASH(srcZone!=0 && targetZone!=0,  ("Bad resolve zones	."));
-	DEBUG_ASSERTCRASH(srcZone<sizeOfZE && targetZone<sizeOfZE,  ("Bad resolve zones	."));
-	srcZone = zoneEquivalency[srcZone];
-	targetZone = zoneEquivalency[targetZone];
-	DEBUG_ASSERTCRASH(srcZone<sizeOfZE && targetZone<sizeOfZE,  ("Bad resolve zones	."));
-	zoneStorageType finalZone;
-	if (targetZone<srcZone) {
-		finalZone = zoneEquivalency[targetZone];
-	} else {
-		finalZone = zoneEquivalency[srcZone];
+	while (zoneEquivalency[zone] != zone) {
+		zoneEquivalency[zone] = zoneEquivalency[zoneEquivalency[zone]]; // path halving
+		zone = zoneEquivalency[zone];
 	}
-	DEBUG_ASSERTCRASH(finalZone<sizeOfZE ,  ("Bad resolve zones	."));
-	for (i=0; i<sizeOfZE; i++) { 
-		zoneStorageType ze = zoneEquivalency[i];
-		if (ze == targetZone || ze == srcZone) {
-			zoneEquivalency[i] = finalZone;
-		}
+	return zone;
+}
+
+inline void unionZones(zoneStorageType *zoneEquivalency, Int zone1, Int zone2)
+{
+	DEBUG_ASSERTCRASH(zone1!=0 && zone2!=0,  ("Bad resolve zones	."));
+	zone1 = findZone(zoneEquivalency, zone1);
+	zone2 = findZone(zoneEquivalency, zone2);
+	// We have two zones being combined now. Keep the lower zone.
+	if (zone1 < zone2) {
+		zoneEquivalency[zone2] = zone1;
+	} else if (zone2 < zone1) {
+		zoneEquivalency[zone1] = zone2;
 	}
 }
 
-static void flattenZones(zoneStorageType *zoneArray, zoneStorageType *zoneHierarchical, Int sizeOfZones)
+/* Make zoneArray include the hierarchical equivalencies as well as its own, and flatten it. */
+static void flattenZones(zoneStorageType *zoneArray, const zoneStorageType *zoneHierarchical, Int sizeOfZones)
 {
 	Int i;
 	for (i=0; i<sizeOfZones; i++) {
-		Int zone1 = zoneArray[i];
-		Int zone2 = zoneHierarchical[zone1];
-		zone1 = zoneArray[zone2];
-		zone2 = zoneHierarchical[zone1];
-		zoneArray[i] = zone2;
+		if (zoneHierarchical[i] != i) {
+			unionZones(zoneArray, i, zoneHierarchical[i]);
+		}
 	}
-#if 1
-
 	for (i=0; i<sizeOfZones; i++) {
-		Int zone1 = zoneArray[i];
-		Int zone2 = zoneHierarchical[i];
-		if (zone1!=zone2) {
-			resolveZones(zone1, zone2, zoneArray, sizeOfZones);
-		}
+		zoneArray[i] = findZone(zoneArray, i);
 	}
-#endif
 }
 
-inline void applyZone(PathfindCell &targetCell, const PathfindCell &sourceCell, zoneStorageType *zoneEquivalency, Int sizeOfZE)
+inline void applyZone(PathfindCell &targetCell, const PathfindCell &sourceCell, zoneStorageType *zoneEquivalency)
 {
 	DEBUG_ASSERTCRASH(sourceCell.getZone()!=0, ("Unset source zone."));
-	Int srcZone = zoneEquivalency[sourceCell.getZone()];
-	//DEBUG_ASSERTCRASH(srcZone!=0, ("Bad zone equivalency zone."));
-	Int targetZone = zoneEquivalency[targetCell.getZone()];
-
-	if (targetZone == 0) {
-		targetCell.setZone(srcZone);
+	if (targetCell.getZone() == 0) {
+		targetCell.setZone(findZone(zoneEquivalency, sourceCell.getZone()));
 		return;
 	}
-	if (targetZone == srcZone) {
-		return; // already match.
+	unionZones(zoneEquivalency, sourceCell.getZone(), targetCell.getZone());
+}
+
+/* Bounds of a zone block, clipped to the map.  Bounds are inclusive. */
+static void getZoneBlockBounds(const IRegion2D &globalBounds, Int xBlock, Int yBlock, IRegion2D &bounds)
+{
+	bounds.lo.x = globalBounds.lo.x + xBlock*PathfindZoneManager::ZONE_BLOCK_SIZE;
+	bounds.lo.y = globalBounds.lo.y + yBlock*PathfindZoneManager::ZONE_BLOCK_SIZE;
+	bounds.hi.x = bounds.lo.x + PathfindZoneManager::ZONE_BLOCK_SIZE - 1; 
+	bounds.hi.y = bounds.lo.y + PathfindZoneManager::ZONE_BLOCK_SIZE - 1;
+	if (bounds.hi.x > globalBounds.hi.x) {
+		bounds.hi.x = globalBounds.hi.x;
 	}
-	resolveZones(srcZone, targetZone, zoneEquivalency, sizeOfZE);
+	if (bounds.hi.y > globalBounds.hi.y) {
+		bounds.hi.y = globalBounds.hi.y;
+	}
+}
+
+/* Flood one zone block with raw zone numbers starting at nextZone.  Touching cells of the same
+type are merged in zoneEquivalency.  Returns the next unused raw zone number. */
+static Int floodBlockZones(PathfindCell **map, const IRegion2D &bounds, zoneStorageType *zoneEquivalency, 
+													 Int nextZone, Bool &interactsWithBridge)
+{
+	Int i, j;
+	for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
+		for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
+			PathfindCell *cell = &map[i][j];
+			cell->setZone(0);
 
+			if (i>bounds.lo.x) {
+				if (map[i][j].getType() == map[i-1][j].getType()) {
+					applyZone(map[i][j], map[i-1][j], zoneEquivalency);
+				}
+			}
+			if (j>bounds.lo.y) {
+				if (map[i][j].getType() == map[i][j-1].getType()) {
+					applyZone(map[i][j], map[i][j-1], zoneEquivalency);
+				}
+			}
+			if (cell->getZone()==0) {
+				cell->setZone(nextZone);
+				nextZone++;
+			}
+			if (cell->getConnectLayer() > LAYER_GROUND) {
+				interactsWithBridge = true;
+			}
+		}
+	}
+	return nextZone;
 }
 
 inline void applyBlockZone(PathfindCell &targetCell, const PathfindCell &sourceCell,
@@ -1955,7 +2079,8 @@ m_groundWaterZones(NULL),
 m_groundRubbleZones(NULL), 
 m_crusherZones(NULL), 
 m_zonesAllocated(0),
-m_interactsWithBridge(FALSE)
+m_interactsWithBridge(FALSE),
+m_modified(FALSE)
 {		
 	m_cellOrigin.x = 0;
 	m_cellOrigin.y = 0;
@@ -2163,7 +2288,12 @@ m_crusherZones(NULL),
 m_hierarchicalZones(NULL), 
 m_blockOfZoneBlocks(NULL),
 m_zoneBlocks(NULL),
-m_zonesAllocated(0)
+m_zonesAllocated(0),
+m_fullZoneCalculations(0),
+m_incrementalZoneUpdates(0),
+m_fullZoneCalculationTime(0.0f),
+m_incrementalZoneUpdateTime(0.0f),
+m_longestIncrementalZoneUpdateTime(0.0f)
 {		
 	m_zoneBlockExtent.x = 0;
 	m_zoneBlockExtent.y = 0;
@@ -2216,6 +2346,7 @@ void PathfindZoneManager::freeBlocks()
 	}
 	m_zoneBlockExtent.x = 0;
 	m_zoneBlockExtent.y = 0;
+	m_modifiedBlocks.clear(); // they went with the blocks.
 }
 
 /* Allocate zone equivalency arrays large enough to hold m_maxZone entries.  If the arrays are already
@@ -2294,9 +2425,24 @@ void PathfindZoneManager::markZonesDirty( Bool insert )  ///< Called when the zo
 static  Bool  s_stopForceCalling = FALSE;
 #endif
 
+DECLARE_PERF_TIMER(calculateZones)
+DECLARE_PERF_TIMER(updateModifiedZones)
+
+/* Milliseconds since startTime64, a QueryPerformanceCounter() value.  For the zone timing counters. */
+static Real zoneMillisecondsSince(__int64 startTime64)
+{
+	__int64 endTime64, freq64;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	return (Real)((double)(endTime64-startTime64) * 1000.0 / (double)freq64);
+}
 
 void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
 {
+	USE_PERF_TIMER(calculateZones)
+
+	__int64 zoneStartTime64;
+	QueryPerformanceCounter((LARGE_INTEGER *)&zoneStartTime64);
 
 #ifdef DEBUG_QPF
 #if defined(DEBUG_LOGGING) 
@@ -2310,6 +2456,7 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 #endif
 #endif
 
+	m_fullZoneCalculations++;
 
 	m_maxZone = 1;	// we start using zone 0 as a flag.
 	const Int maxZones=24000;
@@ -2329,60 +2476,17 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 	for (xBlock = 0; xBlock<xCount; xBlock++) {
 		for (yBlock=0; yBlock<yCount; yBlock++) {
 			IRegion2D bounds;
-			bounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
-			bounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
-			bounds.hi.x = bounds.lo.x + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
-			bounds.hi.y = bounds.lo.y + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
-			if (bounds.hi.x > globalBounds.hi.x) {
-				bounds.hi.x = globalBounds.hi.x;
-			}
-			if (bounds.hi.y > globalBounds.hi.y) {
-				bounds.hi.y = globalBounds.hi.y;
-			}
-//			if (bounds.lo.x>bounds.hi.x || bounds.lo.y>bounds.hi.y) {
-//				DEBUG_CRASH(("Incorrect bounds calculation. Logic error, fix me. jba."));
-//				continue;
-//			}
-			m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(false);
-			for( j=bounds.lo.y; j<=bounds.hi.y; j++ )	{
-				for( i=bounds.lo.x; i<=bounds.hi.x; i++ )	{
-					PathfindCell *cell = &map[i][j];
-					cell->setZone(0);
-
-					if (i>bounds.lo.x) {
-						if (map[i][j].getType() == map[i-1][j].getType()) {
-							applyZone(map[i][j], map[i-1][j], zoneEquivalency, m_maxZone);
-						}
-					}
-					if (j>bounds.lo.y) {
-						if (map[i][j].getType() == map[i][j-1].getType()) {
-							applyZone(map[i][j], map[i][j-1], zoneEquivalency, m_maxZone);
-						}
-					}
-					if (cell->getZone()==0) {
-						cell->setZone(m_maxZone);
-						m_maxZone++;
-//						if (m_maxZone>= maxZones) {
-//							DEBUG_CRASH(("Ran out of pathfind zones.  SERIOUS ERROR! jba."));
-//							break;
-//						}
-					}
-					if (cell->getConnectLayer() > LAYER_GROUND) {
- 						m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(true);
-					}
-					
-				}
-			}
-			//DEBUG_LOG(("Collapsed zones %d\n", m_maxZone));
+			getZoneBlockBounds(globalBounds, xBlock, yBlock, bounds);
+			Bool interactsWithBridge = false;
+			m_maxZone = floodBlockZones(map, bounds, zoneEquivalency, m_maxZone, interactsWithBridge);
+			m_zoneBlocks[xBlock][yBlock].setInteractsWithBridge(interactsWithBridge);
  		}
 	}
 
 	Int totalZones = m_maxZone;
-//	if (totalZones>maxZones/2) {
-//		DEBUG_LOG(("Max zones %d\n", m_maxZone));
-//	}
 
 	// Collapse the zones into a 1,2,3... sequence, removing collapsed zones.
+	// The root of each set is its lowest zone, so it has always been numbered by the time its other zones come up.
 	m_maxZone = 1;
 	Int collapsedZones[maxZones];
 	collapsedZones[0] = 0;
@@ -2390,7 +2494,7 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
   i = 1;
   while ( i < totalZones ) 
   {
-		Int zone = zoneEquivalency[ i ];
+		Int zone = findZone(zoneEquivalency, i);
 		if (zone == i) 
     {
 			collapsedZones[ i ] = m_maxZone;
@@ -2402,34 +2506,6 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
     ++i;
   }
 
-//	for (i=1; i<totalZones; i++) {
-//		Int zone = zoneEquivalency[i];
-//		if (zone == i) {
-//			collapsedZones[i] = m_maxZone;
-//			++m_maxZone;
-//		}	else {
-//			collapsedZones[i] = collapsedZones[zone];
-//		}
-//	}
-  
-
-
-
-
-
-//#ifdef DEBUG_QPF
-//#if defined(DEBUG_LOGGING)
-//	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
-//	timeToUpdate = ((double)(endTime64-startTime64) / (double)(freq64));
-//	DEBUG_LOG(("Time to calculate first %f\n", timeToUpdate));
-//#endif
-//#endif
-
-
-
-
-
-
 	// Now map the zones in the map back into the collapsed zones.
 	j=globalBounds.lo.y;
   while( j<=globalBounds.hi.y )	
@@ -2439,30 +2515,11 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
     {
       PathfindCell &cell = map[i][j];
 			cell.setZone(collapsedZones[cell.getZone()]);
-			
-      //if (cell.getZone()==0) 
-      //{
-			//	DEBUG_CRASH(("Zone not set cell %d, %d", i, j));
-			//}
       ++i;
 		}
     ++j;
 	}
 
-//	for( j=globalBounds.lo.y; j<=globalBounds.hi.y; j++ )	{
-//		for( i=globalBounds.lo.x; i<=globalBounds.hi.x; i++ )	{
-//			map[i][j].setZone(collapsedZones[map[i][j].getZone()]);
-////			if (map[i][j].getZone()==0) {
-////				DEBUG_CRASH(("Zone not set cell %d, %d", i, j));
-////			}
-//		}
-//	}
-
-
-
-
-
-
   i = 0;
 	while ( i <= LAYER_LAST ) 
   {
@@ -2490,163 +2547,82 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
     ++i;
 	}
 
-//	for (i=0; i<=LAYER_LAST; i++) {
-//		Int zone = collapsedZones[layers[i].getZone()];
-//		if (zone == 0) {
-//			zone = m_maxZone;
-//			m_maxZone++;
-//		}
-//		layers[i].setZone( zone );
-////		if (!layers[i].isUnused() && !layers[i].isDestroyed() && layers[i].getZone()==0) {
-////			DEBUG_CRASH(("Zone not set Layer %d", i));
-////		}
-//		layers[i].applyZone();
-//		if (!layers[i].isUnused() && !layers[i].isDestroyed()) {
-//			ICoord2D ndx;
-//			layers[i].getStartCellIndex(&ndx);
-//			setBridge(ndx.x, ndx.y, true);	
-//			layers[i].getEndCellIndex(&ndx);
-//			setBridge(ndx.x, ndx.y, true);	
-//		}
-//	}
-
-
-
-
-
-
 	allocateZones();
 
-
-
-//	DEBUG_ASSERTCRASH(xBlock==m_zoneBlockExtent.x && yBlock==m_zoneBlockExtent.y, ("Inconsistent allocation - SERIOUS ERROR. jba"));
 	for (xBlock=0; xBlock<xCount; xBlock++) 
   {
 		for (yBlock=0; yBlock<yCount; yBlock++) 
     {
 			IRegion2D bounds;
-			bounds.lo.x = globalBounds.lo.x + xBlock*ZONE_BLOCK_SIZE;
-			bounds.lo.y = globalBounds.lo.y + yBlock*ZONE_BLOCK_SIZE;
-			bounds.hi.x = bounds.lo.x + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
-			bounds.hi.y = bounds.lo.y + ZONE_BLOCK_SIZE - 1; // bounds are inclusive.
-			
-      if (bounds.hi.x > globalBounds.hi.x) 
-				bounds.hi.x = globalBounds.hi.x;
-			
-      if (bounds.hi.y > globalBounds.hi.y) 
-				bounds.hi.y = globalBounds.hi.y;
-
-// Although a good safeguard, the logic is already proven, thus skip the check
-//			if (bounds.lo.x>bounds.hi.x || bounds.lo.y>bounds.hi.y) {
-//				DEBUG_CRASH(("Incorrect bounds calculation. Logic error, fix me. jba."));
-//				continue;
-//			}
+			getZoneBlockBounds(globalBounds, xBlock, yBlock, bounds);
 			m_zoneBlocks[xBlock][yBlock].blockCalculateZones(map, layers, bounds);
 		}
 	}
 
+	calculateZoneEquivalencies(map, layers, globalBounds);
 
+#ifdef DEBUG_QPF
+#if defined(DEBUG_LOGGING) 
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
+	timeToUpdate = ((double)(endTime64-startTime64) / (double)(freq64));
 
+  if ( updateSamples < 400 )
+  {
+    averageTimeToUpdate = ((averageTimeToUpdate * updateSamples) + timeToUpdate) / (updateSamples + 1.0f);
+    updateSamples++;
+  	DEBUG_LOG(("computing...: %f, \n", averageTimeToUpdate));
+  }
+  else if ( updateSamples == 400 )
+  {
+  	DEBUG_LOG((" =============DONE============= Average time to calculate zones: %f, \n", averageTimeToUpdate));
+  	DEBUG_LOG(("                                           Percent of baseline : %f, \n", averageTimeToUpdate/0.003335f));
+    updateSamples = 777;
+#ifdef forceRefreshCalling
+    s_stopForceCalling = TRUE;
+#endif
+  }
 
-//#ifdef DEBUG_QPF
-//#if defined(DEBUG_LOGGING) 
-//	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
-//	timeToUpdate = ((double)(endTime64-startTime64) / (double)(freq64));
-//	DEBUG_LOG(("Time to calculate second %f\n", timeToUpdate));
-//#endif
-//#endif
-
-
-
-
+#endif
+#endif
+#if defined _DEBUG || defined _INTERNAL
+	debugShowZones(map, globalBounds, 500);
+#endif
+	m_nextFrameToCalculateZones = 0xffffffff;
+	clearModifiedBlocks(); // the full calculation covered them.
+	m_fullZoneCalculationTime += zoneMillisecondsSince(zoneStartTime64);
+}
 
+/**
+ * Build the equivalency tables that join zones across cell types (water/ground, cliff/ground, etc.)
+ * and across blocks.  The cell zones & block tables have to be up to date.
+ */
+void PathfindZoneManager::calculateZoneEquivalencies( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
+{
 	// Determine water/ground equivalent zones, and ground/cliff equivalent zones.
-//	for (i=0; i<m_zonesAllocated; i++) {
-//		m_groundCliffZones[i] = i;
-//		m_groundWaterZones[i] = i;
-//		m_groundRubbleZones[i] = i;
-//		m_terrainZones[i] = i;
-//		m_crusherZones[i] = i;
-//		m_hierarchicalZones[i] = i;
-//	}
-	i = 0;
-  while ( i < m_zonesAllocated ) 
+	Int i = 0;
+  while ( i < m_zonesAllocated )
 	{
     m_groundCliffZones[i] = m_groundWaterZones[i] = m_groundRubbleZones[i] = m_terrainZones[i] = m_crusherZones[i] = m_hierarchicalZones[i] = i;
     i++;
   }
 
+	applyZoneEquivalencies(map, layers, globalBounds, globalBounds);
+	flattenZoneEquivalencies();
+}
 
-
-
-
-
-//	for( j=globalBounds.lo.y; j<=globalBounds.hi.y; j++ )	{
-//		for( i=globalBounds.lo.x; i<=globalBounds.hi.x; i++ )	{
-//			if ( (map[i][j].getConnectLayer() > LAYER_GROUND) && 
-//				(map[i][j].getType() == PathfindCell::CELL_CLEAR) ) {
-//				PathfindLayer *layer = layers + map[i][j].getConnectLayer();
-//				resolveZones(map[i][j].getZone(), layer->getZone(), m_hierarchicalZones, m_maxZone);
-//			}
-//			if (i>globalBounds.lo.x && map[i][j].getZone()!=map[i-1][j].getZone()) {
-//				if (map[i][j].getType() == map[i-1][j].getType()) {
-//					applyZone(map[i][j], map[i-1][j], m_hierarchicalZones, m_maxZone);
-//				}
-//				if (waterGround(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_groundWaterZones, m_maxZone);
-//				}
-//				if (groundRubble(map[i][j], map[i-1][j])) {
-////					Int zone1 = map[i][j].getZone();
-////					Int zone2 = map[i-1][j].getZone();
-////					if (m_terrainZones[zone1] != m_terrainZones[zone2]) {
-////						//DEBUG_LOG(("Matching terrain zone %d to %d.\n", zone1, zone2));
-////					}
-//					applyZone(map[i][j], map[i-1][j], m_groundRubbleZones, m_maxZone);
-//				}
-//				if (groundCliff(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_groundCliffZones, m_maxZone);
-//				}
-//				if (terrain(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_terrainZones, m_maxZone);
-//				}
-//				if (crusherGround(map[i][j], map[i-1][j])) {
-//					applyZone(map[i][j], map[i-1][j], m_crusherZones, m_maxZone);
-//				}
-//			}
-//			if (j>globalBounds.lo.y && map[i][j].getZone()!=map[i][j-1].getZone()) {
-//				if (map[i][j].getType() == map[i][j-1].getType()) {
-//					applyZone(map[i][j], map[i][j-1], m_hierarchicalZones, m_maxZone);
-//				}
-//				if (waterGround(map[i][j],map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_groundWaterZones, m_maxZone);
-//				}
-//				if (groundRubble(map[i][j], map[i][j-1])) {
-////					Int zone1 = map[i][j].getZone();
-////					Int zone2 = map[i][j-1].getZone();
-////					if (m_terrainZones[zone1] != m_terrainZones[zone2]) {
-////						//DEBUG_LOG(("Matching terrain zone %d to %d.\n", zone1, zone2));
-////					}
-//					applyZone(map[i][j], map[i][j-1], m_groundRubbleZones, m_maxZone);
-//				}
-//				if (groundCliff(map[i][j],map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_groundCliffZones, m_maxZone);
-//				}
-//				if (terrain(map[i][j], map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_terrainZones, m_maxZone);
-//				}
-//				if (crusherGround(map[i][j], map[i][j-1])) {
-//					applyZone(map[i][j], map[i][j-1], m_crusherZones, m_maxZone);
-//				}
-//			}
-//		//	DEBUG_ASSERTCRASH(map[i][j].getZone() != 0, ("Cleared the zone."));
-//		}
-//	}
-  register UnsignedInt maxZone = m_maxZone;
-	j=globalBounds.lo.y;
-  while( j <= globalBounds.hi.y )	
+/**
+ * Merge the zones of touching cells in cellBounds into the equivalency tables.  Each cell is merged
+ * with its left and top neighbors, so to catch every edge of an area, cellBounds has to reach one
+ * cell past the area's right and bottom sides.  The tables have to be flattened afterwards.
+ */
+void PathfindZoneManager::applyZoneEquivalencies( PathfindCell **map, PathfindLayer layers[], const IRegion2D &cellBounds, const IRegion2D &globalBounds )
+{
+	Int i, j;
+	j=cellBounds.lo.y;
+  while( j <= cellBounds.hi.y )	
   {
-    i=globalBounds.lo.x;
-		while( i <= globalBounds.hi.x )	
+    i=cellBounds.lo.x;
+		while( i <= cellBounds.hi.x )	
     {
       PathfindCell &r_thisCell = map[i][j];
 
@@ -2654,7 +2630,7 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
 				(r_thisCell.getType() == PathfindCell::CELL_CLEAR) ) 
       {
 				PathfindLayer *layer = layers + r_thisCell.getConnectLayer();
-				resolveZones(r_thisCell.getZone(), layer->getZone(), m_hierarchicalZones, maxZone);
+				unionZones(m_hierarchicalZones, r_thisCell.getZone(), layer->getZone());
 			}
 
 			if ( i > globalBounds.lo.x && r_thisCell.getZone() != map[i-1][j].getZone() ) 
@@ -2662,31 +2638,31 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
         const PathfindCell &r_leftCell = map[i-1][j];
 
 				if (r_thisCell.getType() == r_leftCell.getType()) 
-					applyZone(r_thisCell, r_leftCell, m_hierarchicalZones, maxZone);//if this is true, skip all the ones below
+					unionZones(m_hierarchicalZones, r_thisCell.getZone(), r_leftCell.getZone());//if this is true, skip all the ones below
         else
         {
           Bool notTerrainOrCrusher = TRUE; // if this is false, skip the if-else-ladder below 
 
           if (terrain(r_thisCell, r_leftCell)) 
           {
-					  applyZone(r_thisCell, r_leftCell, m_terrainZones, maxZone);
+					  unionZones(m_terrainZones, r_thisCell.getZone(), r_leftCell.getZone());
             notTerrainOrCrusher = FALSE;
           }
 
           if (crusherGround(r_thisCell, r_leftCell)) 
           {
-					  applyZone(r_thisCell, r_leftCell, m_crusherZones, maxZone); 
+					  unionZones(m_crusherZones, r_thisCell.getZone(), r_leftCell.getZone()); 
             notTerrainOrCrusher = FALSE;
           }
 
           if ( notTerrainOrCrusher )
           {
             if (waterGround(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundWaterZones, maxZone);
+					    unionZones(m_groundWaterZones, r_thisCell.getZone(), r_leftCell.getZone());
             else if (groundRubble(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundRubbleZones, maxZone);
+					    unionZones(m_groundRubbleZones, r_thisCell.getZone(), r_leftCell.getZone());
             else if (groundCliff(r_thisCell, r_leftCell)) 
-					    applyZone(r_thisCell, r_leftCell, m_groundCliffZones, maxZone);
+					    unionZones(m_groundCliffZones, r_thisCell.getZone(), r_leftCell.getZone());
           }
 
         }
@@ -2698,143 +2674,347 @@ void PathfindZoneManager::calculateZones( PathfindCell **map, PathfindLayer laye
         const PathfindCell &r_topCell = map[i][j-1];
 
         if (r_thisCell.getType() == r_topCell.getType()) 
-					applyZone(r_thisCell, r_topCell, m_hierarchicalZones, maxZone);
+					unionZones(m_hierarchicalZones, r_thisCell.getZone(), r_topCell.getZone());
         else
         {
           Bool notTerrainOrCrusher = TRUE; // if this is false, skip the if-else-ladder below 
 
           if (terrain(r_thisCell, r_topCell)) 
           {
-            applyZone(r_thisCell, r_topCell, m_terrainZones, maxZone);
+            unionZones(m_terrainZones, r_thisCell.getZone(), r_topCell.getZone());
             notTerrainOrCrusher = FALSE;
           }
 
           if (crusherGround(r_thisCell, r_topCell)) 
           {
-					  applyZone(r_thisCell, r_topCell, m_crusherZones, maxZone);
+					  unionZones(m_crusherZones, r_thisCell.getZone(), r_topCell.getZone());
             notTerrainOrCrusher = FALSE;
           }
 
           if (waterGround(r_thisCell,r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundWaterZones, maxZone);
+					  unionZones(m_groundWaterZones, r_thisCell.getZone(), r_topCell.getZone());
           else if (groundRubble(r_thisCell, r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundRubbleZones, maxZone);
+					  unionZones(m_groundRubbleZones, r_thisCell.getZone(), r_topCell.getZone());
           else if (groundCliff(r_thisCell,r_topCell)) 
-					  applyZone(r_thisCell, r_topCell, m_groundCliffZones, maxZone);
+					  unionZones(m_groundCliffZones, r_thisCell.getZone(), r_topCell.getZone());
 
         }
 
       }
 
-//			DEBUG_ASSERTCRASH(r_thisCell.getZone() != 0, ("Cleared the zone."));
-
       ++i;
 		}
 
     ++j; 
 	}
+}
 
+/**
+ * Point every entry in the equivalency tables straight at the root of its set, the way the
+ * getEffectiveZone() lookups read them, and fold the hierarchical zones into the others.
+ */
+void PathfindZoneManager::flattenZoneEquivalencies(void)
+{
+	Int i;
+	for (i=0; i<m_maxZone; i++) {
+		m_hierarchicalZones[i] = findZone(m_hierarchicalZones, i);
+	}
 
+	flattenZones(m_groundCliffZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_groundWaterZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_groundRubbleZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_terrainZones, m_hierarchicalZones, m_maxZone);
+	flattenZones(m_crusherZones, m_hierarchicalZones, m_maxZone);
+}
 
 
+/* Join two zones in a local union-find table, and note an outside zone that shares an edge with a new zone. */
+static void joinLocalZones(std::vector<zoneStorageType> &localZones, std::vector<zoneStorageType> &touchingZones,
+													 Int zone1, Int zone2, Int firstNewZone)
+{
+	if (zone1 == zone2) {
+		return;
+	}
+	if (zone1 >= firstNewZone && zone2 < firstNewZone) {
+		touchingZones.push_back(zone2);
+	} else if (zone2 >= firstNewZone && zone1 < firstNewZone) {
+		touchingZones.push_back(zone1);
+	}
+	unionZones(&localZones[0], zone1, zone2);
+}
 
+/**
+ * Merging redone blocks into the equivalency tables can join zones, but not split them.  Check that the
+ * outside zones touching the redone blocks, which were in the same hierarchical zone before, are still
+ * joined by the cells in and right around the blocks.  If they aren't, a structure may have cut a zone
+ * in two.  The cells of the redone blocks are the ones numbered firstNewZone and up.
+ */
+Bool PathfindZoneManager::modifiedZonesMaySplit( PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds, Int firstNewZone )
+{
+	std::vector<zoneStorageType> localZones(m_maxZone);
+	std::vector<zoneStorageType> touchingZones;
+	Int i, j, k;
+	for (i=0; i<m_maxZone; i++) {
+		localZones[i] = i;
+	}
+
+	Int numBlocks = m_modifiedBlocks.size();
+	for (k=0; k<numBlocks; k++) {
+		IRegion2D cellBounds;
+		getZoneBlockBounds(globalBounds, m_modifiedBlocks[k].x, m_modifiedBlocks[k].y, cellBounds);
+		// One cell into the neighboring blocks all around.
+		cellBounds.lo.x--;
+		cellBounds.lo.y--;
+		cellBounds.hi.x++;
+		cellBounds.hi.y++;
+		if (cellBounds.lo.x < globalBounds.lo.x) cellBounds.lo.x = globalBounds.lo.x;
+		if (cellBounds.lo.y < globalBounds.lo.y) cellBounds.lo.y = globalBounds.lo.y;
+		if (cellBounds.hi.x > globalBounds.hi.x) cellBounds.hi.x = globalBounds.hi.x;
+		if (cellBounds.hi.y > globalBounds.hi.y) cellBounds.hi.y = globalBounds.hi.y;
+
+		for( j=cellBounds.lo.y; j<=cellBounds.hi.y; j++ )	{
+			for( i=cellBounds.lo.x; i<=cellBounds.hi.x; i++ )	{
+				const PathfindCell &cell = map[i][j];
+				if (i>cellBounds.lo.x && cell.getType() == map[i-1][j].getType()) {
+					joinLocalZones(localZones, touchingZones, cell.getZone(), map[i-1][j].getZone(), firstNewZone);
+				}
+				if (j>cellBounds.lo.y && cell.getType() == map[i][j-1].getType()) {
+					joinLocalZones(localZones, touchingZones, cell.getZone(), map[i][j-1].getZone(), firstNewZone);
+				}
+				if (cell.getZone() >= firstNewZone && (cell.getConnectLayer() > LAYER_GROUND) &&
+					(cell.getType() == PathfindCell::CELL_CLEAR) ) {
+					PathfindLayer *layer = layers + cell.getConnectLayer();
+					joinLocalZones(localZones, touchingZones, cell.getZone(), layer->getZone(), firstNewZone);
+				}
+			}
+		}
+	}
+
+	// Outside zones that were in the same hierarchical zone have to still be joined locally.
+	std::vector<zoneStorageType> joinedTo(m_maxZone, UNINITIALIZED_ZONE);
+	Int numTouching = touchingZones.size();
+	for (k=0; k<numTouching; k++) {
+		Int zone = touchingZones[k];
+		Int oldZone = m_hierarchicalZones[zone];
+		if (joinedTo[oldZone] == UNINITIALIZED_ZONE) {
+			joinedTo[oldZone] = zone;
+		} else if (findZone(&localZones[0], joinedTo[oldZone]) != findZone(&localZones[0], zone)) {
+			return true;
+		}
+	}
+	return false;
+}
 
+/* Forget the blocks recorded by updateZonesForModify(). */
+void PathfindZoneManager::clearModifiedBlocks(void)
+{
+	Int numBlocks = m_modifiedBlocks.size();
+	Int k;
+	for (k=0; k<numBlocks; k++) {
+		m_zoneBlocks[m_modifiedBlocks[k].x][m_modifiedBlocks[k].y].setModified(false);
+	}
+	m_modifiedBlocks.clear();
+}
 
+/**
+ * Update zones where a structure has been added or removed.
+ * The cells get approximate zones right away, and the zone blocks the structure touches are
+ * recorded, so that updateModifiedZones() can redo them once per frame.
+ */
+void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds )
+{
+	fillModifiedZones(map, structureBounds, globalBounds);
 
+	if (m_zoneBlocks==NULL || m_hierarchicalZones==NULL) {
+		// Zones were never calculated.
+		markZonesDirty( true );
+		return;
+	}
 
-//	if (m_maxZone >= m_zonesAllocated) {
-//		RELEASE_CRASH("Pathfind allocation error - fatal. see jba.");
-//	}
+	// One cell of slop, so the blocks on the far side of a structure edge get redone too.
+	Int xBlockLo = (structureBounds.lo.x - 1 - globalBounds.lo.x)/ZONE_BLOCK_SIZE;
+	Int yBlockLo = (structureBounds.lo.y - 1 - globalBounds.lo.y)/ZONE_BLOCK_SIZE;
+	Int xBlockHi = (structureBounds.hi.x + 1 - globalBounds.lo.x)/ZONE_BLOCK_SIZE;
+	Int yBlockHi = (structureBounds.hi.y + 1 - globalBounds.lo.y)/ZONE_BLOCK_SIZE;
+	if (xBlockLo < 0) xBlockLo = 0;
+	if (yBlockLo < 0) yBlockLo = 0;
+	if (xBlockHi >= m_zoneBlockExtent.x) xBlockHi = m_zoneBlockExtent.x-1;
+	if (yBlockHi >= m_zoneBlockExtent.y) yBlockHi = m_zoneBlockExtent.y-1;
 
-//	for (i=1; i<m_maxZone; i++) {
-//		// Flatten hierarchical zones.
-//		Int zone = m_hierarchicalZones[i];
-//		m_hierarchicalZones[i] = m_hierarchicalZones[zone];
-//	}
-  //FLATTEN HIERARCHICAL ZONES
-  {
-	  i = 1;
-    register Int zone;  
-    while ( i < (int)maxZone ) 
-    {		// Flatten hierarchical zones.
-		  zone = m_hierarchicalZones[i];
-		  m_hierarchicalZones[i] = m_hierarchicalZones[ zone ];
-      ++i;
-	  }
-  }
+	Int xBlock, yBlock;
+	for (xBlock = xBlockLo; xBlock<=xBlockHi; xBlock++) {
+		for (yBlock = yBlockLo; yBlock<=yBlockHi; yBlock++) {
+			ZoneBlock &block = m_zoneBlocks[xBlock][yBlock];
+			if (block.isModified()) {
+				continue;
+			}
+			block.setModified(true);
+			ICoord2D blockNdx;
+			blockNdx.x = xBlock;
+			blockNdx.y = yBlock;
+			m_modifiedBlocks.push_back(blockNdx);
+		}
+	}
+}
 
-  
-  
-  //THIS BLOCK IS 20% 
-	flattenZones(m_groundCliffZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundWaterZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_groundRubbleZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_terrainZones, m_hierarchicalZones, m_maxZone);
-	flattenZones(m_crusherZones, m_hierarchicalZones, m_maxZone);
+/**
+ * Redo the zone blocks recorded by updateZonesForModify() since the last call, so the zones are exact
+ * without waiting for a full calculateZones().  Each block is flooded on its own into a fresh range of
+ * zone numbers, and only the edges in and around the redone blocks are merged into the equivalency
+ * tables.  A block's old numbers stay in the tables, so the zones that were joined through them stay
+ * joined, and the block's new zones join them again where they touch.
+ */
+void PathfindZoneManager::updateModifiedZones(PathfindCell **map, PathfindLayer layers[], const IRegion2D &globalBounds )
+{
+	if (m_modifiedBlocks.empty()) {
+		return;
+	}
+	if (m_hierarchicalZones==NULL) {
+		clearModifiedBlocks(); // a full recalculation is coming anyway.
+		return;
+	}
 
+	// Worst case every cell in the redone blocks needs a new zone number.
+	Int numBlocks = m_modifiedBlocks.size();
+	if (m_maxZone + numBlocks*ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE >= MAX_ZONE) {
+		// The fresh ranges have used up the zone numbers, so renumber the whole map.
+		calculateZones(map, layers, globalBounds);
+		return;
+	}
 
-#ifdef DEBUG_QPF
-#if defined(DEBUG_LOGGING) 
-	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
-	timeToUpdate = ((double)(endTime64-startTime64) / (double)(freq64));
+	USE_PERF_TIMER(updateModifiedZones)
 
-//	DEBUG_LOG(("Time to calculate zones %f, cells %d\n", timeToUpdate, (globalBounds.hi.x-globalBounds.lo.x)*(globalBounds.hi.y-globalBounds.lo.y)));
-  if ( updateSamples < 400 )
-  {
-    averageTimeToUpdate = ((averageTimeToUpdate * updateSamples) + timeToUpdate) / (updateSamples + 1.0f);
-    updateSamples++;
-  	DEBUG_LOG(("computing...: %f, \n", averageTimeToUpdate));
-  }
-  else if ( updateSamples == 400 )
-  {
-  	DEBUG_LOG((" =============DONE============= Average time to calculate zones: %f, \n", averageTimeToUpdate));
-  	DEBUG_LOG(("                                           Percent of baseline : %f, \n", averageTimeToUpdate/0.003335f));
-    updateSamples = 777;
-#ifdef forceRefreshCalling
-    s_stopForceCalling = TRUE;
-#endif
-  }
+	__int64 zoneStartTime64;
+	QueryPerformanceCounter((LARGE_INTEGER *)&zoneStartTime64);
 
-#endif
-#endif
-#if defined _DEBUG || defined _INTERNAL
-	if (TheGlobalData->m_debugAI == AI_DEBUG_ZONES) 
-	{
-		extern void addIcon(const Coord3D *pos, Real width, Int numFramesDuration, RGBColor color);
-		RGBColor color;
-		memset(&color, 0, sizeof(Color));
-		addIcon(NULL, 0, 0, color);
-		for( j=0; j<globalBounds.hi.y; j++ )	{
-			for( i=0; i<globalBounds.hi.x; i++ )	{
-				Int zone = map[i][j].getZone();
-				//zone = m_terrainZones[zone];
-				//zone = m_groundCliffZones[zone];
-				zone = m_hierarchicalZones[zone];
-
-				color.blue = (zone%3) * 0.5f;
-				zone = zone/3;
-				color.green = (zone%3) * 0.5f;
-				zone = zone/3;
-				color.red = (zone%3) * 0.5;
-				Coord3D pos;
-				pos.x = ((Real)i + 0.5f) * PATHFIND_CELL_SIZE_F;
-				pos.y = ((Real)j + 0.5f) * PATHFIND_CELL_SIZE_F;
-				pos.z = TheTerrainLogic->getLayerHeight( pos.x, pos.y, map[i][j].getLayer() ) + 0.5f;
-				addIcon(&pos, PATHFIND_CELL_SIZE_F*0.8f, 500, color);
+	m_incrementalZoneUpdates++;
+
+	Int firstNewZone = m_maxZone;
+	Int i, j, k;
+	for (k=0; k<numBlocks; k++) {
+		ZoneBlock &block = m_zoneBlocks[m_modifiedBlocks[k].x][m_modifiedBlocks[k].y];
+		IRegion2D blockBounds;
+		getZoneBlockBounds(globalBounds, m_modifiedBlocks[k].x, m_modifiedBlocks[k].y, blockBounds);
+
+		zoneStorageType blockEquivalency[ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1];
+		for (i=0; i<ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1; i++) {
+			blockEquivalency[i] = i;
+		}
+		Bool interactsWithBridge = false;
+		Int rawZones = floodBlockZones(map, blockBounds, blockEquivalency, 1, interactsWithBridge);
+		block.setInteractsWithBridge(interactsWithBridge);
+
+		// Collapse into a fresh range at the end, so the block's old numbers keep their meaning
+		// for the zones around it.
+		Int collapsedZones[ZONE_BLOCK_SIZE*ZONE_BLOCK_SIZE+1];
+		for (i=1; i<rawZones; i++) {
+			Int zone = findZone(blockEquivalency, i);
+			if (zone == i) {
+				collapsedZones[i] = m_maxZone;
+				m_maxZone++;
+			} else {
+				collapsedZones[i] = collapsedZones[zone];
+			}
+		}
+		for( j=blockBounds.lo.y; j<=blockBounds.hi.y; j++ )	{
+			for( i=blockBounds.lo.x; i<=blockBounds.hi.x; i++ )	{
+				PathfindCell &cell = map[i][j];
+				cell.setZone(collapsedZones[cell.getZone()]);
 			}
 		}
 	}
+
+	for (i=0; i<=LAYER_LAST; i++) {
+		PathfindLayer &r_thisLayer = layers[i];
+    if (!r_thisLayer.isUnused() && !r_thisLayer.isDestroyed())
+    {
+			ICoord2D ndx;
+			r_thisLayer.getStartCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);
+			r_thisLayer.getEndCellIndex(&ndx);
+			setBridge(ndx.x, ndx.y, true);
+		}
+	}
+
+	Bool reallocated = (m_maxZone >= m_zonesAllocated);
+	allocateZones();
+
+	for (k=0; k<numBlocks; k++) {
+		IRegion2D blockBounds;
+		getZoneBlockBounds(globalBounds, m_modifiedBlocks[k].x, m_modifiedBlocks[k].y, blockBounds);
+		m_zoneBlocks[m_modifiedBlocks[k].x][m_modifiedBlocks[k].y].blockCalculateZones(map, layers, blockBounds);
+	}
+
+	if (reallocated) {
+		// The tables grew, and came back empty, so there is nothing to merge into.
+		calculateZoneEquivalencies(map, layers, globalBounds);
+	} else {
+		if (modifiedZonesMaySplit(map, layers, globalBounds, firstNewZone)) {
+			// The merge below can't split the zone, so have a full calculation do it later.
+			markZonesDirty( true );
+		}
+		for (k=0; k<numBlocks; k++) {
+			IRegion2D cellBounds;
+			getZoneBlockBounds(globalBounds, m_modifiedBlocks[k].x, m_modifiedBlocks[k].y, cellBounds);
+			// One past the right & bottom, for the edges to the blocks there.
+			if (cellBounds.hi.x < globalBounds.hi.x) cellBounds.hi.x++;
+			if (cellBounds.hi.y < globalBounds.hi.y) cellBounds.hi.y++;
+			applyZoneEquivalencies(map, layers, cellBounds, globalBounds);
+		}
+		flattenZoneEquivalencies();
+	}
+	clearModifiedBlocks();
+
+#if defined _DEBUG || defined _INTERNAL
+	debugShowZones(map, globalBounds, 200);
 #endif
-	m_nextFrameToCalculateZones = 0xffffffff;
-}
 
+	Real updateTime = zoneMillisecondsSince(zoneStartTime64);
+	m_incrementalZoneUpdateTime += updateTime;
+	if (m_longestIncrementalZoneUpdateTime < updateTime) {
+		m_longestIncrementalZoneUpdateTime = updateTime;
+	}
+}
 
+#if defined _DEBUG || defined _INTERNAL
+/**
+ * Show each cell's hierarchical zone as a colored icon, if the zone debug display is on.
+ */
+void PathfindZoneManager::debugShowZones(PathfindCell **map, const IRegion2D &globalBounds, Int numFramesDuration)
+{
+	if (TheGlobalData->m_debugAI != AI_DEBUG_ZONES || m_hierarchicalZones == NULL) {
+		return;
+	}
+	extern void addIcon(const Coord3D *pos, Real width, Int numFramesDuration, RGBColor color);
+	RGBColor color;
+	memset(&color, 0, sizeof(Color));
+	addIcon(NULL, 0, 0, color);
+	Int i, j;
+	for( j=0; j<globalBounds.hi.y; j++ )	{
+		for( i=0; i<globalBounds.hi.x; i++ )	{
+			Int zone = map[i][j].getZone();
+			zone = m_hierarchicalZones[zone];
+
+			color.blue = (zone%3) * 0.5f;
+			zone = zone/3;
+			color.green = (zone%3) * 0.5f;
+			zone = zone/3;
+			color.red = (zone%3) * 0.5;
+			Coord3D pos;
+			pos.x = ((Real)i + 0.5f) * PATHFIND_CELL_SIZE_F;
+			pos.y = ((Real)j + 0.5f) * PATHFIND_CELL_SIZE_F;
+			pos.z = TheTerrainLogic->getLayerHeight( pos.x, pos.y, map[i][j].getLayer() ) + 0.5f;
+			addIcon(&pos, PATHFIND_CELL_SIZE_F*0.8f, numFramesDuration, color);
+		}
+	}
+}
+#endif
 
 /**
- * Update zones where a structure has been added or removed.
- * This can be done by just updating the equivalency arrays, without rezoning the map..
+ * Give the cells under a structure that was added or removed a zone from their neighbors.
+ * This isn't exact, and is only used until updateModifiedZones() or calculateZones() redoes the area.
  */
-void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer layers[], const IRegion2D &structureBounds, const IRegion2D &globalBounds )
+void PathfindZoneManager::fillModifiedZones(PathfindCell **map, const IRegion2D &structureBounds, const IRegion2D &globalBounds )
 {
 
 #ifdef DEBUG_QPF
@@ -2943,32 +3123,7 @@ void PathfindZoneManager::updateZonesForModify(PathfindCell **map, PathfindLayer
 #endif
 #endif
 #if defined _DEBUG || defined _INTERNAL
-	if (TheGlobalData->m_debugAI==AI_DEBUG_ZONES) 
-	{
-		extern void addIcon(const Coord3D *pos, Real width, Int numFramesDuration, RGBColor color);
-		RGBColor color;
-		memset(&color, 0, sizeof(Color));
-		addIcon(NULL, 0, 0, color);
-		Int i, j;
-		for( j=0; j<globalBounds.hi.y; j++ )	{
-			for( i=0; i<globalBounds.hi.x; i++ )	{
-				Int zone = map[i][j].getZone();
-				//zone = m_terrainZones[zone];
-				zone = m_hierarchicalZones[zone];
-
-				color.blue = (zone%3) * 0.5f;
-				zone = zone/3;
-				color.green = (zone%3) * 0.5f;
-				zone = zone/3;
-				color.red = (zone%3) * 0.5;
-				Coord3D pos;
-				pos.x = ((Real)i + 0.5f) * PATHFIND_CELL_SIZE_F;
-				pos.y = ((Real)j + 0.5f) * PATHFIND_CELL_SIZE_F;
-				pos.z = TheTerrainLogic->getLayerHeight( pos.x, pos.y, map[i][j].getLayer() ) + 0.5f;
-				addIcon(&pos, PATHFIND_CELL_SIZE_F*0.8f, 200, color);
-			}
-		}
-	}
+	debugShowZones(map, globalBounds, 200);
 #endif
 
 }
@@ -3881,11 +4036,15 @@ void Pathfinder::reset( void )
 	debugPath = NULL;
 	m_frameToShowObstacles = 0;
 
-	for (m_queuePRHead=0; m_queuePRHead<PATHFIND_QUEUE_LEN; m_queuePRHead++) {
-		m_queuedPathfindRequests[m_queuePRHead] = INVALID_ID;
+	Int lane;
+	for (lane=0; lane<PATHFIND_PRIORITY_COUNT; lane++) {
+		for (i=0; i<PATHFIND_QUEUE_LEN; i++) {
+			m_queuedPathfindRequests[lane][i] = INVALID_ID;
+		}
+		m_queuePRHead[lane] = 0;
+		m_queuePRTail[lane] = 0;
 	}
-	m_queuePRHead = 0;
-	m_queuePRTail = 0;
+	m_queuedPathfindLane.clear();
 
 	m_numWallPieces = 0;
 	for (i=0; i<MAX_WALL_PIECES; ++i)
@@ -4066,7 +4225,6 @@ void Pathfinder::classifyFence( Object *obj, Bool insert )
  		}
  	}
 	if (didAnything) {
-		m_zoneManager.markZonesDirty( insert );
 		m_zoneManager.updateZonesForModify(m_map, m_layers, cellBounds, m_extent);
 	}
 #if 0 
@@ -4208,8 +4366,6 @@ void Pathfinder::internal_classifyObjectFootprint( Object *obj, Bool insert )
 	{
 		case GEOMETRY_BOX:
 		{
-			m_zoneManager.markZonesDirty( insert );
-      
 			Real angle = obj->getOrientation();
 
 			Real halfsizeX = obj->getGeometryInfo().getMajorRadius();
@@ -4267,7 +4423,6 @@ void Pathfinder::internal_classifyObjectFootprint( Object *obj, Bool insert )
 		case GEOMETRY_SPHERE:	// not quite right, but close enough
 		case GEOMETRY_CYLINDER:
 		{
-			m_zoneManager.markZonesDirty( insert );
 			// fill in all cells that overlap as obstacle cells
 			/// @todo This is a very inefficient circle-rasterizer
 			ICoord2D topLeft, bottomRight;
@@ -4707,8 +4862,9 @@ void Pathfinder::debugShowSearch(  Bool pathFound  )
 		addIcon(NULL, 0, 0, color);	 // erase.
 	}
 
-	for( s = m_openList; s; s=s->getNextOpen() )
+	for( Int i = 0; m_openList && i < PathfindCell::getOpenListCount(); i++ )
 	{
+		s = PathfindCell::getOpenListCell(i);
 		// create objects to show path - they decay
 		RGBColor color;
 		color.red = color.green = 0;
@@ -5645,7 +5801,7 @@ Bool Pathfinder::adjustToPossibleDestination(Object *obj, const LocomotorSet& lo
  * Queues an object to do a pathfind.
  * It will call the object's ai update->doPathfind() during processPathfindQueue().
  */
-Bool Pathfinder::queueForPath(ObjectID id)
+Bool Pathfinder::queueForPath(ObjectID id, PathfindQueuePriority priority)
 {
 #if defined(_DEBUG) || defined(_INTERNAL)
 	{
@@ -5660,29 +5816,44 @@ Bool Pathfinder::queueForPath(ObjectID id)
 	}
 #endif
 	
-	/* Check & see if we are already queued. */
-	Int slot = m_queuePRHead;
-	while (slot != m_queuePRTail) {
-		if (m_queuedPathfindRequests[slot] == id) {
-			return true;
-		}
-		slot++;
-		if (slot >= PATHFIND_QUEUE_LEN) {
-			slot = 0;
-		}
+	if (id == INVALID_ID) {
+		return false;
+	}
+	DEBUG_ASSERTCRASH(priority >= 0 && priority < PATHFIND_PRIORITY_COUNT, ("Bad pathfind priority."));
+
+	/* Check & see if we are already queued in this lane or a faster one. */
+	UnsignedInt idNdx = (UnsignedInt)id;
+	if (idNdx >= m_queuedPathfindLane.size()) {
+		m_queuedPathfindLane.resize(idNdx+1+idNdx/2, 0);
+	}
+	UnsignedByte queuedLane = m_queuedPathfindLane[idNdx];
+	if (queuedLane != 0 && queuedLane-1 <= priority) {
+		return true;
 	}
 
 	// Tail is the first available slot.
-	Int nextSlot = m_queuePRTail+1;
+	Int nextSlot = m_queuePRTail[priority]+1;
 	if (nextSlot >= PATHFIND_QUEUE_LEN) {
 		nextSlot = 0;
 	}
-	if (nextSlot==m_queuePRHead) {
+	if (nextSlot==m_queuePRHead[priority]) {
 		DEBUG_CRASH(("Ran out of pathfind queue slots."));
 		return false;
 	}
-	m_queuedPathfindRequests[m_queuePRTail] = id;
-	m_queuePRTail = nextSlot;
+	// If we were queued in a slower lane, take that entry out so we aren't served twice.
+	if (queuedLane != 0) {
+		Int oldLane = queuedLane-1;
+		Int slot;
+		for (slot = m_queuePRHead[oldLane]; slot != m_queuePRTail[oldLane]; slot = (slot+1 < PATHFIND_QUEUE_LEN) ? slot+1 : 0) {
+			if (m_queuedPathfindRequests[oldLane][slot] == id) {
+				m_queuedPathfindRequests[oldLane][slot] = INVALID_ID;
+				break;
+			}
+		}
+	}
+	m_queuedPathfindRequests[priority][m_queuePRTail[priority]] = id;
+	m_queuePRTail[priority] = nextSlot;
+	m_queuedPathfindLane[idNdx] = (UnsignedByte)(priority+1);
 	return true;
 }
 
@@ -5907,6 +6078,7 @@ void Pathfinder::processPathfindQueue(void)
 		m_zoneManager.calculateZones(m_map, m_layers, m_extent);
 		return;
 	}
+	m_zoneManager.updateModifiedZones(m_map, m_layers, m_extent);
 
 	// Get the current logical extent.
 	Region3D terrainExtent;
@@ -5924,10 +6096,29 @@ void Pathfinder::processPathfindQueue(void)
 #ifdef DEBUG_QPF
 	Int pathsFound = 0;
 #endif
-	while (m_cumulativeCellsAllocated < PATHFIND_CELLS_PER_FRAME && 
-		m_queuePRTail!=m_queuePRHead) {
-		Object *obj = TheGameLogic->findObjectByID(m_queuedPathfindRequests[m_queuePRHead]);
-		m_queuedPathfindRequests[m_queuePRHead] = INVALID_ID;
+	// Note - the requests have to be served one at a time, in queue order.  Each search borrows
+	// PathfindCellInfos from the shared pool and hangs them on the map cells, and doPathfind()
+	// then claims goal cells (updateGoal) that the following searches in the same frame path around.
+	// Solving a frame's batch concurrently would need per-search cell infos and open lists, plus
+	// a serial pass to redo any search whose goal cells were claimed ahead of it.
+	Int lane = PATHFIND_PRIORITY_PLAYER;
+	while (m_cumulativeCellsAllocated < PATHFIND_CELLS_PER_FRAME && lane < PATHFIND_PRIORITY_COUNT) {
+		if (m_queuePRTail[lane]==m_queuePRHead[lane]) {
+			lane++;
+			continue;
+		}
+		ObjectID id = m_queuedPathfindRequests[lane][m_queuePRHead[lane]];
+		m_queuedPathfindRequests[lane][m_queuePRHead[lane]] = INVALID_ID;
+		m_queuePRHead[lane] = m_queuePRHead[lane]+1;
+		if (m_queuePRHead[lane] >= PATHFIND_QUEUE_LEN) {
+			m_queuePRHead[lane] = 0;
+		}
+		if (id == INVALID_ID) {
+			continue; // promoted to a faster lane.
+		}
+		DEBUG_ASSERTCRASH((UnsignedInt)id < m_queuedPathfindLane.size() && m_queuedPathfindLane[id] == lane+1, ("Pathfind queue lane table is out of sync."));
+		m_queuedPathfindLane[id] = 0;
+		Object *obj = TheGameLogic->findObjectByID(id);
 		if (obj) {
 			AIUpdateInterface *ai = obj->getAIUpdateInterface();
 			if (ai) {
@@ -5937,10 +6128,8 @@ void Pathfinder::processPathfindQueue(void)
 #endif
 			}
 		}
-		m_queuePRHead = m_queuePRHead+1;
-		if (m_queuePRHead >= PATHFIND_QUEUE_LEN) {
-			m_queuePRHead = 0;
-		}
+		// Serving a path may have queued someone in a faster lane.
+		lane = PATHFIND_PRIORITY_PLAYER;
 	}
 	if (pathsFound>0) {
 #ifdef DEBUG_QPF
@@ -11085,11 +11274,13 @@ void Pathfinder::crc( Xfer *xfer )
 	xfer->xferUser(&m_ignoreObstacleID, sizeof(ObjectID));
 	CRCDEBUG_LOG(("m_ignoreObstacleID: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
 
-	xfer->xferUser(m_queuedPathfindRequests, sizeof(ObjectID)*PATHFIND_QUEUE_LEN);
+	// one ring buffer per priority lane, fastest first.  (this layout is xfer version 2;
+	// a build with the single queue will CRC differently, so it can't play against this one.)
+	xfer->xferUser(m_queuedPathfindRequests, sizeof(ObjectID)*PATHFIND_QUEUE_LEN*PATHFIND_PRIORITY_COUNT);
 	CRCDEBUG_LOG(("m_queuedPathfindRequests: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
-	xfer->xferInt(&m_queuePRHead);
+	xfer->xferUser(m_queuePRHead, sizeof(Int)*PATHFIND_PRIORITY_COUNT);
 	CRCDEBUG_LOG(("m_queuePRHead: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
-	xfer->xferInt(&m_queuePRTail);
+	xfer->xferUser(m_queuePRTail, sizeof(Int)*PATHFIND_PRIORITY_COUNT);
 	CRCDEBUG_LOG(("m_queuePRTail: %8.8X\n", ((XferCRC *)xfer)->getCRC()));
 
 	xfer->xferInt(&m_numWallPieces);
@@ -11112,7 +11303,10 @@ void Pathfinder::xfer( Xfer *xfer )
 {
 
 	// version
-	XferVersion currentVersion = 1;
+	// 1: initial version
+	// 2: the pathfind queue is split into priority lanes, which changes what crc() feeds
+	//    the CRC.  (the queue itself isn't saved, so there's nothing new to load.)
+	XferVersion currentVersion = 2;
 	XferVersion version = currentVersion;
 	xfer->xferVersion( &version, currentVersion );
 
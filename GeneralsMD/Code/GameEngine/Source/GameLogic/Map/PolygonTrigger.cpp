@@ -35,9 +35,65 @@
 #include "GameLogic/PolygonTrigger.h"
 #include "GameLogic/TerrainLogic.h"
 
+/* ********* PolygonTriggerIndex ****************************/
+/**
+	A uniform grid over the trigger bounds. Each cell holds the triggers whose bounds
+	touch it, in list order, packed into one array (cell i owns entries
+	m_cellStart[i] .. m_cellStart[i+1]-1). Triggers only change in the editor and
+	on map load, so it's simply rebuilt from scratch when they do.
+*/
+struct PolygonTriggerIndex
+{
+	enum { MAX_CELLS_PER_SIDE = 64 };
+
+	IRegion2D					m_extent;			///< union of all the indexed bounds.
+	Int								m_cellSize;
+	Int								m_cellCountX;
+	Int								m_cellCountY;
+	Int*							m_cellStart;
+	PolygonTrigger**	m_entries;
+
+	void clear()
+	{
+		delete [] m_cellStart;
+		m_cellStart = NULL;
+		delete [] m_entries;
+		m_entries = NULL;
+		m_cellCountX = m_cellCountY = 0;
+	}
+
+	Int cellX(Int x) const 
+	{ 
+		Int cx = (x - m_extent.lo.x) / m_cellSize; 
+		return cx < m_cellCountX ? cx : m_cellCountX-1;
+	}
+
+	Int cellY(Int y) const 
+	{ 
+		Int cy = (y - m_extent.lo.y) / m_cellSize; 
+		return cy < m_cellCountY ? cy : m_cellCountY-1;
+	}
+
+	PolygonTrigger* const* lookup(const ICoord3D &point, Int *count) const
+	{
+		*count = 0;
+		if (m_cellStart == NULL || 
+				point.x < m_extent.lo.x || point.y < m_extent.lo.y || 
+				point.x > m_extent.hi.x || point.y > m_extent.hi.y)
+			return NULL;
+		Int cell = cellY(point.y) * m_cellCountX + cellX(point.x);
+		*count = m_cellStart[cell+1] - m_cellStart[cell];
+		return m_entries + m_cellStart[cell];
+	}
+};
+
+static PolygonTriggerIndex s_triggerIndex;			///< every trigger.
+static PolygonTriggerIndex s_waterTriggerIndex;	///< just the water areas.
+
 /* ********* PolygonTrigger class ****************************/
 PolygonTrigger *PolygonTrigger::ThePolygonTriggerListPtr = NULL;
 Int PolygonTrigger::s_currentID = 1;
+Bool PolygonTrigger::s_triggerIndexValid = false;
 /**
  PolygonTrigger - Constructor.
 */
@@ -53,8 +109,9 @@ m_selected(false),
 //Added By Sadullah Nader
 //Initializations inserted
 m_isRiver(FALSE),
-m_riverStart(0)
+m_riverStart(0),
 //
+m_isAxisAlignedRect(false)
 {
 	if (initialAllocation < 2) initialAllocation = 2;
 	m_points = NEW ICoord3D[initialAllocation];		// pool[]ify
@@ -125,6 +182,100 @@ PolygonTrigger *PolygonTrigger::getPolygonTriggerByID(Int triggerID)
 
 }
 
+/**
+* Rebuild the trigger indices from the current list of triggers.
+*/
+void PolygonTrigger::buildTriggerIndex(void)
+{
+	for (Int pass = 0; pass < 2; ++pass)
+	{
+		Bool waterAreasOnly = (pass == 1);
+		PolygonTriggerIndex &index = waterAreasOnly ? s_waterTriggerIndex : s_triggerIndex;
+		index.clear();
+
+		Int numTriggers = 0;
+		PolygonTrigger *pTrig;
+		for (pTrig = getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) 
+		{
+			if (waterAreasOnly && !pTrig->isWaterArea())
+				continue;
+			if (pTrig->m_numPoints == 0)
+				continue;
+			if (pTrig->m_boundsNeedsUpdate)
+				pTrig->updateBounds();
+			if (numTriggers == 0)
+			{
+				index.m_extent = pTrig->m_bounds;
+			}
+			else
+			{
+				if (pTrig->m_bounds.lo.x < index.m_extent.lo.x) index.m_extent.lo.x = pTrig->m_bounds.lo.x;
+				if (pTrig->m_bounds.lo.y < index.m_extent.lo.y) index.m_extent.lo.y = pTrig->m_bounds.lo.y;
+				if (pTrig->m_bounds.hi.x > index.m_extent.hi.x) index.m_extent.hi.x = pTrig->m_bounds.hi.x;
+				if (pTrig->m_bounds.hi.y > index.m_extent.hi.y) index.m_extent.hi.y = pTrig->m_bounds.hi.y;
+			}
+			++numTriggers;
+		}
+		if (numTriggers == 0)
+			continue;
+
+		// roughly one cell per trigger, spread over the extent.
+		Int cellsPerSide = 1;
+		while (cellsPerSide * cellsPerSide < numTriggers && cellsPerSide < PolygonTriggerIndex::MAX_CELLS_PER_SIDE)
+			++cellsPerSide;
+		Int width = index.m_extent.hi.x - index.m_extent.lo.x + 1;
+		Int height = index.m_extent.hi.y - index.m_extent.lo.y + 1;
+		index.m_cellSize = ((width > height ? width : height) + cellsPerSide - 1) / cellsPerSide;
+		if (index.m_cellSize < 1) 
+			index.m_cellSize = 1;
+		index.m_cellCountX = (width + index.m_cellSize - 1) / index.m_cellSize;
+		index.m_cellCountY = (height + index.m_cellSize - 1) / index.m_cellSize;
+
+		Int numCells = index.m_cellCountX * index.m_cellCountY;
+		index.m_cellStart = NEW Int[numCells + 1];
+		memset(index.m_cellStart, 0, sizeof(Int) * (numCells + 1));
+
+		// count, then turn the counts into start offsets, then fill. filling in list
+		// order keeps each cell's triggers in list order.
+		Int cx, cy;
+		for (pTrig = getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) 
+		{
+			if ((waterAreasOnly && !pTrig->isWaterArea()) || pTrig->m_numPoints == 0)
+				continue;
+			for (cy = index.cellY(pTrig->m_bounds.lo.y); cy <= index.cellY(pTrig->m_bounds.hi.y); ++cy)
+				for (cx = index.cellX(pTrig->m_bounds.lo.x); cx <= index.cellX(pTrig->m_bounds.hi.x); ++cx)
+					++index.m_cellStart[cy * index.m_cellCountX + cx + 1];
+		}
+		for (Int i = 0; i < numCells; ++i)
+			index.m_cellStart[i+1] += index.m_cellStart[i];
+
+		index.m_entries = NEW PolygonTrigger*[index.m_cellStart[numCells] > 0 ? index.m_cellStart[numCells] : 1];
+		Int *fill = NEW Int[numCells];
+		memcpy(fill, index.m_cellStart, sizeof(Int) * numCells);
+		for (pTrig = getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) 
+		{
+			if ((waterAreasOnly && !pTrig->isWaterArea()) || pTrig->m_numPoints == 0)
+				continue;
+			for (cy = index.cellY(pTrig->m_bounds.lo.y); cy <= index.cellY(pTrig->m_bounds.hi.y); ++cy)
+				for (cx = index.cellX(pTrig->m_bounds.lo.x); cx <= index.cellX(pTrig->m_bounds.hi.x); ++cx)
+					index.m_entries[fill[cy * index.m_cellCountX + cx]++] = pTrig;
+		}
+		delete [] fill;
+	}
+	s_triggerIndexValid = true;
+}
+
+/**
+* Find the triggers whose bounds contain the point, in list order. Any trigger that
+* isn't returned is guaranteed to fail pointInTrigger for this point.
+*/
+PolygonTrigger* const* PolygonTrigger::getTriggersAt(const ICoord3D &point, Bool waterAreasOnly, Int *count)
+{
+	if (!s_triggerIndexValid)
+		buildTriggerIndex();
+	return (waterAreasOnly ? s_waterTriggerIndex : s_triggerIndex).lookup(point, count);
+}
+
 /**
 * PolygonTrigger::ParsePolygonTriggersDataChunk - read a polygon triggers chunk.
 * Format is the newer CHUNKY format.
@@ -283,6 +434,7 @@ void PolygonTrigger::updateBounds(void)	const
 		if (m_points[i].y > m_bounds.hi.y) m_bounds.hi.y = m_points[i].y;
 	}
 	m_boundsNeedsUpdate = 0;
+	m_isAxisAlignedRect = calcIsAxisAlignedRect();
 	Real halfWidth = (m_bounds.hi.x - m_bounds.lo.x) / 2.0f;
 	Real halfHeight = (m_bounds.hi.y + m_bounds.lo.y) / 2.0f;
 
@@ -290,6 +442,22 @@ void PolygonTrigger::updateBounds(void)	const
 }
 
 
+/**
+ PolygonTrigger::calcIsAxisAlignedRect - true if the polygon is 4 points joined by 
+ alternating horizontal and vertical edges, in which case it is exactly its bounds.
+*/
+Bool PolygonTrigger::calcIsAxisAlignedRect(void) const
+{
+	if (m_numPoints != 4) 
+		return false;
+	const ICoord3D *p = m_points;
+	if (p[0].y == p[1].y && p[1].x == p[2].x && p[2].y == p[3].y && p[3].x == p[0].x)
+		return p[0].x != p[1].x && p[1].y != p[2].y;
+	if (p[0].x == p[1].x && p[1].y == p[2].y && p[2].x == p[3].x && p[3].y == p[0].y)
+		return p[0].y != p[1].y && p[1].x != p[2].x;
+	return false;
+}
+
 /**
  PolygonTrigger::addPolygonTrigger adds a trigger to the list of triggers.
 */
@@ -301,6 +469,7 @@ void PolygonTrigger::addPolygonTrigger(PolygonTrigger *pTrigger)
 	}
 	pTrigger->m_nextPolygonTrigger = ThePolygonTriggerListPtr;
 	ThePolygonTriggerListPtr = pTrigger;
+	invalidateTriggerIndex();
 }
 
 /**
@@ -326,6 +495,7 @@ void PolygonTrigger::removePolygonTrigger(PolygonTrigger *pTrigger)
 		}
 	}
 	pTrigger->m_nextPolygonTrigger = NULL;
+	invalidateTriggerIndex();
 }
 
 /**
@@ -337,6 +507,9 @@ void PolygonTrigger::deleteTriggers(void)
 	ThePolygonTriggerListPtr = NULL;
 	s_currentID = 1;
 	pList->deleteInstance();
+	s_triggerIndex.clear();
+	s_waterTriggerIndex.clear();
+	invalidateTriggerIndex();
 }
 
 /**
@@ -353,6 +526,7 @@ void PolygonTrigger::addPoint(const ICoord3D &point)
 	m_points[m_numPoints] = point;
 	m_numPoints++;
 	m_boundsNeedsUpdate = true;
+	invalidateTriggerIndex();
 }
 
 /**
@@ -373,6 +547,7 @@ void PolygonTrigger::setPoint(const ICoord3D &point, Int ndx)
 	}
 	m_points[ndx] = point;
 	m_boundsNeedsUpdate = true;
+	invalidateTriggerIndex();
 }
 
 /**
@@ -398,6 +573,7 @@ void PolygonTrigger::insertPoint(const ICoord3D &point, Int ndx)
 	m_points[ndx] = point;
 	m_numPoints++;
 	m_boundsNeedsUpdate = true;
+	invalidateTriggerIndex();
 }
 
 /**
@@ -415,6 +591,7 @@ void PolygonTrigger::deletePoint(Int ndx)
 	}
 	m_numPoints--;
 	m_boundsNeedsUpdate = true;
+	invalidateTriggerIndex();
 }
 
 void PolygonTrigger::getCenterPoint(Coord3D* pOutCoord)	const
@@ -455,6 +632,12 @@ Bool PolygonTrigger::pointInTrigger(ICoord3D &point) const
 	if (point.x > m_bounds.hi.x) return false;
 	if (point.y > m_bounds.hi.y) return false;
 
+	if (m_isAxisAlignedRect) {
+		// same answer the crossing test below gives for a rectangle: the low edges
+		// are outside, the high edges inside.
+		return point.x > m_bounds.lo.x && point.y > m_bounds.lo.y;
+	}
+
 	Bool inside = false;
 	Int i;
 	for (i=0; i<m_numPoints; i++) {
@@ -549,6 +732,12 @@ void PolygonTrigger::xfer( Xfer *xfer )
 	// bounds need update
 	xfer->xferBool( &m_boundsNeedsUpdate );
 
+	if( xfer->getXferMode() == XFER_LOAD )
+	{
+		m_isAxisAlignedRect = calcIsAxisAlignedRect();
+		invalidateTriggerIndex();
+	}
+
 }  // end xfer
 
 // ------------------------------------------------------------------------------------------------
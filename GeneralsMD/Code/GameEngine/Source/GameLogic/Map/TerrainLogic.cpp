@@ -2192,13 +2192,11 @@ const WaterHandle* TerrainLogic::getWaterHandle( Real x, Real y )
 	iLoc.z = 0;
 
 	// Look for water areas in the polygon triggers
-	for( PolygonTrigger *pTrig = PolygonTrigger::getFirstPolygonTrigger(); 
-			 pTrig; 
-			 pTrig = pTrig->getNext() ) 
+	Int numCandidates;
+	PolygonTrigger* const* candidates = PolygonTrigger::getTriggersAt( iLoc, TRUE, &numCandidates );
+	for( Int c = 0; c < numCandidates; ++c ) 
 	{
-
-		if( !pTrig->isWaterArea() ) 
-			continue;
+		PolygonTrigger *pTrig = candidates[ c ];
 
 		// See if point is in a water area
 		if( pTrig->pointInTrigger( iLoc ) ) 
@@ -2636,8 +2636,12 @@ void Object::setTriggerAreaFlagsForChangeInPosition()
 
 	m_iPos = iPos;
 
-	for (const PolygonTrigger *pTrig = PolygonTrigger::getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) 
+	// only the triggers whose bounds hold us can possibly contain us.
+	Int numCandidates;
+	PolygonTrigger* const* candidates = PolygonTrigger::getTriggersAt(m_iPos, false, &numCandidates);
+	for (Int c = 0; c < numCandidates; ++c) 
 	{
+		const PolygonTrigger *pTrig = candidates[c];
 		Bool skip = false;
 		for (i = 0; i < m_numTriggerAreasActive; i++) 
 		{
@@ -94,6 +94,9 @@
 	Int64 s_timeInClosestObjects = 0;
 	Int64 s_timeInClosestObjectsThisFrame = 0;
 	UnsignedInt s_gcoPerfFrame = 0xffffffff;
+	Int s_contactPairsThisFrame = 0;
+	Int s_contactBroadphaseRejectsThisFrame = 0;
+	Int s_contactHitsThisFrame = 0;
 #endif 
 
 #ifdef _INTERNAL
@@ -1232,24 +1235,7 @@ PartitionCell::PartitionCell()
 	m_loTerrainZ = HUGE_DIST;		// huge positive
 	m_hiTerrainZ = -HUGE_DIST;	// huge negative
 #endif
-	/*
-		You may be asking yourself: why do we model the shroud for all players,
-		rather than just the local player? And the answer is: because this allows
-		us to checksum these values for net games, to help prevent "shroud cheaters"
-		(who use a trainer to disable the shroud on their system).
-	*/
-	for (int i = 0; i < MAX_PLAYER_COUNT; ++i)
-	{
-		// Default is "passive shroud".  1,0.
-		m_shroudLevel[i].m_currentShroud = 1;
-		m_shroudLevel[i].m_activeShroudLevel = 0;
-
-		// default cash value is 0
-		m_cashValue[i] = 0;
-
-		// default threat value is 0
-		m_threatValue[i] = 0;
-	}
+	// (our shroud, threat, and cash values are set up by PartitionManager::init)
 }
 
 //-----------------------------------------------------------------------------
@@ -1269,133 +1255,147 @@ void PartitionCell::invalidateShroudedStatusForAllCois(Int playerIndex)
 }
 
 //-----------------------------------------------------------------------------
-void PartitionCell::addLooker(Int playerIndex)
+inline ShroudLevel& PartitionCell::getShroudLevel( Int playerIndex ) const
 {
-	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
-	// The decreasing Algorithm: A 1 will go straight to -1, otherwise it just gets decremented
-	m_shroudLevel[playerIndex].m_currentShroud = min( m_shroudLevel[playerIndex].m_currentShroud - 1, -1 );
+	return ThePartitionManager->getShroudPlane(playerIndex)[m_cellY * ThePartitionManager->m_cellCountX + m_cellX];
+}
 
-	CellShroudStatus newShroud = getShroudStatusForPlayer( playerIndex );
+//-----------------------------------------------------------------------------
+inline Int& PartitionCell::getThreatRef( Int playerIndex ) const
+{
+	return ThePartitionManager->getThreatPlane(playerIndex)[m_cellY * ThePartitionManager->m_cellCountX + m_cellX];
+}
 
-//	DEBUG_LOG(( "ADD    %d, %d.  CS = %d, AS = %d for player %d.\n", 
-//							m_cellX, 
-//							m_cellY, 
-//							m_shroudLevel[playerIndex].m_currentShroud,
-//							m_shroudLevel[playerIndex].m_activeShroudLevel,
-//							playerIndex
-//							));
+//-----------------------------------------------------------------------------
+inline Int& PartitionCell::getCashRef( Int playerIndex ) const
+{
+	return ThePartitionManager->getCashPlane(playerIndex)[m_cellY * ThePartitionManager->m_cellCountX + m_cellX];
+}
 
-	if( oldShroud != newShroud )
-	{
-		// On an edge trigger, tell all objects to think about their shroudedness
-		invalidateShroudedStatusForAllCois( playerIndex );
+//-----------------------------------------------------------------------------
+// The shroud arithmetic. This is shared by the one-cell-at-a-time PartitionCell calls 
+// and the row-span kernels used by the DiscreteCircle callbacks (see hLineAddLooker et al).
+//-----------------------------------------------------------------------------
+static inline CellShroudStatus shroudStatusFromLevel( const ShroudLevel& level )
+{
+	// There are now three answers, but the question still requires "to whom"
 
-		if( playerIndex == ThePlayerList->getLocalPlayer()->getPlayerIndex() )
-		{
-			// and if this is the local player, do the Client update.
-			TheDisplay->setShroudLevel(m_cellX, m_cellY, newShroud);
-			TheRadar->setShroudLevel(m_cellX, m_cellY, newShroud);
-		}
-	}
+	if( level.m_currentShroud == 1 )
+		return CELLSHROUD_SHROUDED;
+	else if( level.m_currentShroud == 0 )
+		return CELLSHROUD_FOGGED;// ie Nobody actively looking
+	else
+		return CELLSHROUD_CLEAR;
 }
 
 //-----------------------------------------------------------------------------
-void PartitionCell::removeLooker(Int playerIndex)
+static inline void applyAddLooker( ShroudLevel& level )
+{
+	// The decreasing Algorithm: A 1 will go straight to -1, otherwise it just gets decremented
+	level.m_currentShroud = min( level.m_currentShroud - 1, -1 );
+}
+
+//-----------------------------------------------------------------------------
+static inline void applyRemoveLooker( ShroudLevel& level )
 {
-	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
 	// the increasing Algorithm: a -1 goes up to min(1,activeLevel), otherwise it just gets incremented
-	if( m_shroudLevel[playerIndex].m_currentShroud == -1 )
-		m_shroudLevel[playerIndex].m_currentShroud = min( m_shroudLevel[playerIndex].m_activeShroudLevel, (Short)1 );
+	if( level.m_currentShroud == -1 )
+		level.m_currentShroud = min( level.m_activeShroudLevel, (Short)1 );
 	else
 	{
-		DEBUG_CONDWARNING( m_shroudLevel[playerIndex].m_currentShroud < 0, ("Someone is RemoveLooker-ing on a cell that is not looked at.  This will make a permanent shroud blob.") );
-		m_shroudLevel[playerIndex].m_currentShroud++;
+		DEBUG_CONDWARNING( level.m_currentShroud < 0, ("Someone is RemoveLooker-ing on a cell that is not looked at.  This will make a permanent shroud blob.") );
+		level.m_currentShroud++;
 	}
-	CellShroudStatus newShroud = getShroudStatusForPlayer( playerIndex );
-
-//	DEBUG_LOG(( "REMOVE %d, %d.  CS = %d, AS = %d for player %d.\n", 
-//							m_cellX, 
-//							m_cellY, 
-//							m_shroudLevel[playerIndex].m_currentShroud,
-//							m_shroudLevel[playerIndex].m_activeShroudLevel,
-//							playerIndex
-//							));
+}
 
-	if( oldShroud != newShroud )
+//-----------------------------------------------------------------------------
+static inline void applyAddShrouder( ShroudLevel& level )
+{
+	// Increasing active shroud: activeLevel gets incremented, and CS is set to 1 if at zero
+	level.m_activeShroudLevel++;
+	if( level.m_currentShroud == 0 )
 	{
-		// On an edge trigger, tell all objects to think about their shroudedness
-		invalidateShroudedStatusForAllCois( playerIndex );
-
-		if( playerIndex == ThePlayerList->getLocalPlayer()->getPlayerIndex() )
-		{
-			// and if this is the local player, do the Client update.
-			TheDisplay->setShroudLevel(m_cellX, m_cellY, newShroud);
-			TheRadar->setShroudLevel(m_cellX, m_cellY, newShroud);
-		}
+		level.m_currentShroud = 1;
 	}
 }
 
 //-----------------------------------------------------------------------------
-void PartitionCell::addShrouder( Int playerIndex )
+static inline void applyRemoveShrouder( ShroudLevel& level )
 {
-	CellShroudStatus oldShroud = getShroudStatusForPlayer( playerIndex );
-	// Increasing active shroud: activeLevel gets incremented, and CS is set to 1 if at zero
-	// do the algorithm
-	m_shroudLevel[playerIndex].m_activeShroudLevel++;
-	if( m_shroudLevel[playerIndex].m_currentShroud == 0 )
+	// Decreasing active shroud: just decrement activeLevel.  This will never result in a client change.
+	// Either it was passive shroud and is now active, or it was being looked at and still is.
+	level.m_activeShroudLevel--;
+	DEBUG_ASSERTCRASH( level.m_activeShroudLevel >= 0, ("Shroud generation has gone negative.  This can't happen.") );
+}
+
+//-----------------------------------------------------------------------------
+/** Apply a shroud op to 'count' consecutive cells of one player's shroud plane, 'levels' and
+	* 'cells' being the matching spots in the plane and in m_cells. The arithmetic is a tight
+	* walk over one plane; only cells whose status actually flips go back to PartitionCell for 
+	* the (much more expensive) edge-trigger work. */
+//-----------------------------------------------------------------------------
+template <void (*APPLY)( ShroudLevel& )>
+static inline void shroudSpanKernel( ShroudLevel* levels, PartitionCell* cells, Int count, Int playerIndex )
+{
+	for( Int i = 0; i < count; ++i )
 	{
-		m_shroudLevel[playerIndex].m_currentShroud = 1;
+		CellShroudStatus oldShroud = shroudStatusFromLevel( levels[i] );
+		APPLY( levels[i] );
+		CellShroudStatus newShroud = shroudStatusFromLevel( levels[i] );
+		if( oldShroud != newShroud )
+			cells[i].onShroudStatusChanged( playerIndex, newShroud );
 	}
-	CellShroudStatus newShroud = getShroudStatusForPlayer( playerIndex );
+}
 
-	if( oldShroud != newShroud )
-	{
-		// On an edge trigger, tell all objects to think about their shroudedness
-		invalidateShroudedStatusForAllCois( playerIndex );
+//-----------------------------------------------------------------------------
+void PartitionCell::onShroudStatusChanged( Int playerIndex, CellShroudStatus newShroud )
+{
+	// On an edge trigger, tell all objects to think about their shroudedness
+	invalidateShroudedStatusForAllCois( playerIndex );
 
-		// and update the client if we are on the local player
-		if( playerIndex == ThePlayerList->getLocalPlayer()->getPlayerIndex() )
-		{
-			TheDisplay->setShroudLevel(m_cellX, m_cellY, newShroud);
-			TheRadar->setShroudLevel(m_cellX, m_cellY, newShroud);
-		}
+	if( playerIndex == ThePlayerList->getLocalPlayer()->getPlayerIndex() )
+	{
+		// and if this is the local player, do the Client update.
+		TheDisplay->setShroudLevel(m_cellX, m_cellY, newShroud);
+		TheRadar->setShroudLevel(m_cellX, m_cellY, newShroud);
 	}
 }
 
 //-----------------------------------------------------------------------------
-void PartitionCell::removeShrouder( Int playerIndex )
+void PartitionCell::addLooker(Int playerIndex)
 {
-	// Decreasing active shroud: just decrement activeLevel.  This will never result in a client change.
-	// Either it was passive shroud and is now active, or it was being looked at and still is.
-	m_shroudLevel[playerIndex].m_activeShroudLevel--;
-	DEBUG_ASSERTCRASH( m_shroudLevel[playerIndex].m_activeShroudLevel >= 0, ("Shroud generation has gone negative.  This can't happen.") );
+	shroudSpanKernel<applyAddLooker>( &getShroudLevel( playerIndex ), this, 1, playerIndex );
 }
 
 //-----------------------------------------------------------------------------
-//Bool PartitionCell::isShroudedForPlayer( Int playerIndex ) const
-//{
-	// There isn't an absolute answer.  This cell is only shrouded in regards to a person
-//	return (m_shroudLevel[playerIndex].m_currentShroud == 1);
-//}
+void PartitionCell::removeLooker(Int playerIndex)
+{
+	shroudSpanKernel<applyRemoveLooker>( &getShroudLevel( playerIndex ), this, 1, playerIndex );
+}
 
 //-----------------------------------------------------------------------------
-CellShroudStatus PartitionCell::getShroudStatusForPlayer( Int playerIndex ) const
+void PartitionCell::addShrouder( Int playerIndex )
 {
-	// There are now three answers, but the question still requires "to whom"
+	shroudSpanKernel<applyAddShrouder>( &getShroudLevel( playerIndex ), this, 1, playerIndex );
+}
 
-	if( m_shroudLevel[playerIndex].m_currentShroud == 1 )
-		return CELLSHROUD_SHROUDED;
-	else if( m_shroudLevel[playerIndex].m_currentShroud == 0 )
-		return CELLSHROUD_FOGGED;// ie Nobody actively looking
-	else
-		return CELLSHROUD_CLEAR;
+//-----------------------------------------------------------------------------
+void PartitionCell::removeShrouder( Int playerIndex )
+{
+	applyRemoveShrouder( getShroudLevel( playerIndex ) );
+}
+
+//-----------------------------------------------------------------------------
+CellShroudStatus PartitionCell::getShroudStatusForPlayer( Int playerIndex ) const
+{
+	return shroudStatusFromLevel( getShroudLevel( playerIndex ) );
 }
 
 //-----------------------------------------------------------------------------
 UnsignedInt PartitionCell::getThreatValue( Int playerIndex )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
-		return m_threatValue[playerIndex];
+		return getThreatRef(playerIndex);
 	}
 	return 0;
 }
@@ -1404,11 +1404,12 @@ UnsignedInt PartitionCell::getThreatValue( Int playerIndex )
 void PartitionCell::addThreatValue( Int playerIndex, UnsignedInt threatValue )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
+		Int& threat = getThreatRef(playerIndex);
 #ifdef _DEBUG
-		UnsignedInt oldThreatVal = m_threatValue[playerIndex];
+		UnsignedInt oldThreatVal = threat;
 		DEBUG_ASSERTCRASH(oldThreatVal <= oldThreatVal + threatValue, ("adding new threat value overflowed allotted storage."));
 #endif
-		m_threatValue[playerIndex] += threatValue;
+		threat += threatValue;
 	}
 }
 
@@ -1416,11 +1417,12 @@ void PartitionCell::addThreatValue( Int playerIndex, UnsignedInt threatValue )
 void PartitionCell::removeThreatValue( Int playerIndex, UnsignedInt threatValue )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
+		Int& threat = getThreatRef(playerIndex);
 #ifdef _DEBUG
-		UnsignedInt oldThreatVal = m_threatValue[playerIndex];
+		UnsignedInt oldThreatVal = threat;
 		DEBUG_ASSERTCRASH(oldThreatVal >= oldThreatVal - threatValue, ("removing new threat value underflowed allotted storage."));
 #endif
-		m_threatValue[playerIndex] -= threatValue;
+		threat -= threatValue;
 	}
 }
 
@@ -1428,7 +1430,7 @@ void PartitionCell::removeThreatValue( Int playerIndex, UnsignedInt threatValue
 UnsignedInt PartitionCell::getCashValue( Int playerIndex )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
-		return m_cashValue[playerIndex];
+		return getCashRef(playerIndex);
 	}
 	return 0;
 }
@@ -1437,11 +1439,12 @@ UnsignedInt PartitionCell::getCashValue( Int playerIndex )
 void PartitionCell::addCashValue( Int playerIndex, UnsignedInt cashValue )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
+		Int& cash = getCashRef(playerIndex);
 #ifdef _DEBUG
-		UnsignedInt oldCashVal = m_cashValue[playerIndex];
+		UnsignedInt oldCashVal = cash;
 		DEBUG_ASSERTCRASH(oldCashVal <= oldCashVal + cashValue, ("adding new cash value overflowed allotted storage."));
 #endif
-		m_cashValue[playerIndex] += cashValue;
+		cash += cashValue;
 	}
 }
 
@@ -1449,11 +1452,12 @@ void PartitionCell::addCashValue( Int playerIndex, UnsignedInt cashValue )
 void PartitionCell::removeCashValue( Int playerIndex, UnsignedInt cashValue )
 {
 	if (playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT) {
+		Int& cash = getCashRef(playerIndex);
 #ifdef _DEBUG
-		UnsignedInt oldCashVal = m_cashValue[playerIndex];
+		UnsignedInt oldCashVal = cash;
 		DEBUG_ASSERTCRASH(oldCashVal >= oldCashVal - cashValue, ("removing new cash value underflowed allotted storage."));
 #endif
-		m_cashValue[playerIndex] -= cashValue;
+		cash -= cashValue;
 	}
 }
 
@@ -1505,7 +1509,12 @@ void PartitionCell::validateCoiList()
 void PartitionCell::crc( Xfer *xfer )
 {
 
-	xfer->xferUser(&m_shroudLevel, sizeof(ShroudLevel) * MAX_PLAYER_COUNT);
+	// gather our levels out of the per-player planes, so the crc sees the same bytes it always has
+	ShroudLevel shroudLevel[MAX_PLAYER_COUNT];
+	for (Int i = 0; i < MAX_PLAYER_COUNT; ++i)
+		shroudLevel[i] = getShroudLevel(i);
+
+	xfer->xferUser(shroudLevel, sizeof(ShroudLevel) * MAX_PLAYER_COUNT);
 	xfer->xferUser(&m_cellX, sizeof(m_cellX));
 	xfer->xferUser(&m_cellY, sizeof(m_cellY));
 
@@ -1522,8 +1531,16 @@ void PartitionCell::xfer( Xfer *xfer )
 	XferVersion version = currentVersion;
 	xfer->xferVersion( &version, currentVersion );
 
-	// xfer shroud data
-	xfer->xferUser( &m_shroudLevel, sizeof( ShroudLevel ) * MAX_PLAYER_COUNT );
+	// xfer shroud data (gathered from and scattered back to the per-player planes, same format as ever)
+	ShroudLevel shroudLevel[ MAX_PLAYER_COUNT ];
+	Int i;
+	for( i = 0; i < MAX_PLAYER_COUNT; ++i )
+		shroudLevel[ i ] = getShroudLevel( i );
+
+	xfer->xferUser( shroudLevel, sizeof( ShroudLevel ) * MAX_PLAYER_COUNT );
+
+	for( i = 0; i < MAX_PLAYER_COUNT; ++i )
+		getShroudLevel( i ) = shroudLevel[ i ];
 
 }  // end xfer
 
@@ -1552,7 +1569,8 @@ PartitionData::PartitionData()
 	m_coiArrayCount = 0;
 	m_coiArray = NULL;
 	m_coiInUseCount = 0;
-	m_doneFlag = 0;
+	for (int d = 0; d < MAX_GCO_NESTING; ++d)
+		m_doneFlag[d] = 0;
 	m_dirtyStatus = NOT_DIRTY;
 	m_lastCell = NULL;
 	for (int i = 0; i < MAX_PLAYER_COUNT; ++i)
@@ -1991,6 +2009,36 @@ Bool PartitionData::collidesWith(const PartitionData *that, CollideLocAndNormal
 	}
 }
 
+//-----------------------------------------------------------------------------
+/**
+	the xy radius outside of which none of the collide procs can report a hit.
+	circles are collided as squares against rects (see xy_collideTest_Rect_Circle),
+	so their corners reach out to sqrt(2) * radius.
+*/
+inline Real calcContactBroadphaseRadius(const GeometryInfo& geom)
+{
+	if (geom.getGeomType() == GEOMETRY_BOX)
+		return geom.getBoundingCircleRadius();
+	return geom.getBoundingCircleRadius() * 1.4143f;	// just over sqrt(2), to stay conservative
+}
+
+//-----------------------------------------------------------------------------
+/**
+	cheap, conservative xy reject for a contact pair. this must never reject a pair
+	that collidesWith() would accept (it would change the onCollide results), so it
+	uses a padded box around the broadphase radii rather than anything tighter.
+*/
+static Bool contactBroadphaseRejects(const Object *a, const Object *b)
+{
+	const Real BROADPHASE_SLOP = 1.0f;
+
+	Real reach = calcContactBroadphaseRadius(a->getGeometryInfo()) + 
+								calcContactBroadphaseRadius(b->getGeometryInfo()) + BROADPHASE_SLOP;
+	const Coord3D *aPos = a->getPosition();
+	const Coord3D *bPos = b->getPosition();
+	return fabs(aPos->x - bPos->x) > reach || fabs(aPos->y - bPos->y) > reach;
+}
+
 //-----------------------------------------------------------------------------
 /* See if thisObj collides with geom at pos & angle. */
 Bool PartitionManager::geomCollidesWithGeom(const Coord3D* pos1, 
@@ -2486,12 +2534,30 @@ void PartitionContactList::processContactList()
 		if (cd->m_obj == NULL || cd->m_other == NULL)
 			continue;
 
+#ifdef DUMP_PERF_STATS
+		++s_contactPairsThisFrame;
+#endif
+
+		// sharing a cell says very little for big cells and small objects, so throw out
+		// the obvious misses before paying for the real geometry test.
+		if (contactBroadphaseRejects(cd->m_obj->getObject(), cd->m_other->getObject()))
+		{
+#ifdef DUMP_PERF_STATS
+			++s_contactBroadphaseRejectsThisFrame;
+#endif
+			continue;
+		}
+
 		// we know that their partitions overlap; determine if they REALLY collide 
 		// before proceeding...
 		CollideLocAndNormal cinfo;
 		if (!cd->m_obj->friend_collidesWith(cd->m_other, &cinfo))
 			continue;
 
+#ifdef DUMP_PERF_STATS
+		++s_contactHitsThisFrame;
+#endif
+
 		Object* obj = cd->m_obj->getObject();
 		Object* other = cd->m_other->getObject();
 		
@@ -2552,6 +2618,9 @@ PartitionManager::PartitionManager()
 	m_cellCountY = 0;
 	m_totalCellCount = 0;
 	m_cells = NULL;
+	m_shroudPlanes = NULL;
+	m_threatPlanes = NULL;
+	m_cashPlanes = NULL;
 	m_worldExtents.lo.zero();
 	m_worldExtents.hi.zero();
 	m_dirtyModules = NULL;
@@ -2619,6 +2688,28 @@ void PartitionManager::init()
 		m_cellCountY = REAL_TO_INT_CEIL(m_worldExtents.height() * m_cellSizeInv);
 		m_totalCellCount = m_cellCountX * m_cellCountY;
 		m_cells = new PartitionCell[m_totalCellCount];
+
+		/*
+			You may be asking yourself: why do we model the shroud for all players,
+			rather than just the local player? And the answer is: because this allows
+			us to checksum these values for net games, to help prevent "shroud cheaters"
+			(who use a trainer to disable the shroud on their system).
+		*/
+		Int planeCellCount = MAX_PLAYER_COUNT * m_totalCellCount;
+		m_shroudPlanes = new ShroudLevel[planeCellCount];
+		m_threatPlanes = new Int[planeCellCount];
+		m_cashPlanes = new Int[planeCellCount];
+		for (Int i = 0; i < planeCellCount; ++i)
+		{
+			// Default is "passive shroud".  1,0.
+			m_shroudPlanes[i].m_currentShroud = 1;
+			m_shroudPlanes[i].m_activeShroudLevel = 0;
+
+			// default threat and cash values are 0
+			m_threatPlanes[i] = 0;
+			m_cashPlanes[i] = 0;
+		}
+
 		for (Int x = 0; x < m_cellCountX; x++)
 		{
 			for (Int y = 0; y < m_cellCountY; y++)
@@ -2645,6 +2736,9 @@ void PartitionManager::init()
 		m_cellCountY = 0;
 		m_totalCellCount = 0;
 		m_cells = NULL;
+		m_shroudPlanes = NULL;
+		m_threatPlanes = NULL;
+		m_cashPlanes = NULL;
 		m_worldExtents.lo.zero();
 		m_worldExtents.hi.zero();
 	}
@@ -2662,6 +2756,14 @@ void PartitionManager::getPMStats(double& gcoTimeThisFrameTotal, double& gcoTime
 	gcoTimeThisFrameTotal = gcoTimeInMSecs;
 	gcoTimeThisFrameAvg = gcoTimeInMSecs / (double)s_countInClosestObjectsThisFrame;
 }
+
+//-----------------------------------------------------------------------------
+void PartitionManager::getPMContactStats(Int& pairsThisFrame, Int& broadphaseRejectsThisFrame, Int& hitsThisFrame)
+{
+	pairsThisFrame = s_contactPairsThisFrame;
+	broadphaseRejectsThisFrame = s_contactBroadphaseRejectsThisFrame;
+	hitsThisFrame = s_contactHitsThisFrame;
+}
 #endif
 
 //-----------------------------------------------------------------------------
@@ -2673,6 +2775,9 @@ void PartitionManager::reset()
 	s_countInClosestObjectsThisFrame = 0;
 	s_timeInClosestObjectsThisFrame = 0;
 	s_gcoPerfFrame = 0xffffffff;
+	s_contactPairsThisFrame = 0;
+	s_contactBroadphaseRejectsThisFrame = 0;
+	s_contactHitsThisFrame = 0;
 #endif
 
 	resetPendingUndoShroudRevealQueue();
@@ -2707,6 +2812,12 @@ void PartitionManager::shutdown()
 	
 	delete [] m_cells;
 	m_cells = NULL;
+	delete [] m_shroudPlanes;
+	m_shroudPlanes = NULL;
+	delete [] m_threatPlanes;
+	m_threatPlanes = NULL;
+	delete [] m_cashPlanes;
+	m_cashPlanes = NULL;
 
 	m_cellSize = m_cellSizeInv = 0.0f;
 	m_cellCountX = 0;
@@ -2730,6 +2841,12 @@ void PartitionManager::update()
 			m_updatedSinceLastReset = true;
 		}
 
+#ifdef DUMP_PERF_STATS
+		s_contactPairsThisFrame = 0;
+		s_contactBroadphaseRejectsThisFrame = 0;
+		s_contactHitsThisFrame = 0;
+#endif
+
 		PartitionContactList ctList;
 		TheContactList = &ctList;
 		while (m_dirtyModules)
@@ -2988,10 +3105,7 @@ void PartitionManager::revealMapForPlayerPermanently( Int playerIndex )
 	// By skipping the removeLooker, I consider myself as actively looking at everything, 
 	// so Shroud generation will no longer function
 	// By adding a looker directly I don't hit the Ally logic of the normal look/doShroudReveal
-	for (int i = 0; i < m_totalCellCount; ++i) 
-	{
-		m_cells[i].addLooker( playerIndex );
-	}
+	shroudSpanKernel<applyAddLooker>( getShroudPlane( playerIndex ), m_cells, m_totalCellCount, playerIndex );
 }
 
 /** 
@@ -3004,10 +3118,7 @@ void PartitionManager::undoRevealMapForPlayerPermanently( Int playerIndex )
 
 	// This will have amusing consequences if done without a preceding revealMapForPlayerPermanently.
 	// Everything you own can become shrouded.
-	for (int i = 0; i < m_totalCellCount; ++i) 
-	{
-		m_cells[i].removeLooker( playerIndex );
-	}
+	shroudSpanKernel<applyRemoveLooker>( getShroudPlane( playerIndex ), m_cells, m_totalCellCount, playerIndex );
 }
 
 /** 
@@ -3034,11 +3145,12 @@ void PartitionManager::refreshShroudForLocalPlayer()
 	TheRadar->clearShroud();
 
 	Int playerIndex = ThePlayerList->getLocalPlayer()->getPlayerIndex();
+	const ShroudLevel* levels = getShroudPlane(playerIndex);
 	for (int i = 0; i < m_totalCellCount; ++i)
 	{
 		Int x = m_cells[i].getCellX();
 		Int y = m_cells[i].getCellY();
-		CellShroudStatus status = m_cells[i].getShroudStatusForPlayer(playerIndex);
+		CellShroudStatus status = shroudStatusFromLevel(levels[i]);
 		TheDisplay->setShroudLevel(x, y, status);
 		TheRadar->setShroudLevel(x, y, status);
 		m_cells[i].invalidateShroudedStatusForAllCois(playerIndex);
@@ -3199,6 +3311,58 @@ void PartitionManager::calcRadiusVec()
 }
 #endif
 
+//-----------------------------------------------------------------------------
+/**
+	Each getClosestObjects walk gets one of these. An object can be in several cells, so the walk
+	stamps each PartitionData it has looked at; the context picks which of the PartitionData's 
+	done-flags to stamp (one per nesting level) and a fresh stamp value. That way a filter that
+	makes a query of its own no longer tramples the done-flags of the query that called it.
+	Past MAX_GCO_NESTING there are no done-flags left, so the walk keeps its own set instead.
+*/
+//-----------------------------------------------------------------------------
+class GCOQueryContext
+{
+private:
+	static Int s_depth;
+	static Int s_iterFlag;
+
+	Int m_depth;
+	Int m_iterFlag;
+	std::set<PartitionData*> *m_seen;		///< only when nested too deeply for the done-flags
+
+public:
+	GCOQueryContext() : m_seen(NULL)
+	{
+		m_depth = s_depth++;
+		m_iterFlag = ++s_iterFlag;	// nonzero, thanks
+		if (m_depth >= MAX_GCO_NESTING)
+		{
+			DEBUG_LOG(("getClosestObjects nested %d deep, slow path; consider increasing MAX_GCO_NESTING\n", m_depth + 1));
+			m_seen = NEW std::set<PartitionData*>;
+		}
+	}
+
+	~GCOQueryContext()
+	{
+		--s_depth;
+		delete m_seen;
+	}
+
+	/// return true if we'd already looked at this module; either way, it's marked as looked-at now.
+	inline Bool checkAndMarkDone(PartitionData *mod) const
+	{
+		if (m_seen)
+			return !m_seen->insert(mod).second;
+		if (mod->friend_getDoneFlag(m_depth) == m_iterFlag)
+			return true;
+		mod->friend_setDoneFlag(m_depth, m_iterFlag);
+		return false;
+	}
+};
+
+Int GCOQueryContext::s_depth = 0;
+Int GCOQueryContext::s_iterFlag = 1;
+
 //-----------------------------------------------------------------------------
 //DECLARE_PERF_TIMER(getClosestObjects)
 Object *PartitionManager::getClosestObjects(
@@ -3228,12 +3392,6 @@ Object *PartitionManager::getClosestObjects(
 	GetPrecisionTimer(&startTime64);
 #endif
 	
-#ifdef _DEBUG
-	static Int theEntrancyCount = 0;
-	DEBUG_CONDWARNING(theEntrancyCount == 0, ("sorry, this routine is not reentrant"));
-	++theEntrancyCount;
-#endif
-
 	DEBUG_CONDWARNING((obj==NULL) != (pos == NULL), ("either obj or pos must be null"));
 
 	DistCalcProc distProc = theDistCalcProcs[dc];
@@ -3278,8 +3436,7 @@ Object *PartitionManager::getClosestObjects(
 
 	Bool foundAny = false;
 
-	static Int theIterFlag = 1;	// nonzero, thanks
-	++theIterFlag;
+	GCOQueryContext context;
 
 	/*
 		m_radiusVec[curRadius] contains a list of the cells (foo) that could
@@ -3307,9 +3464,8 @@ Object *PartitionManager::getClosestObjects(
 
 				// since an object can exist in multiple COIs, we use this to avoid processing
 				// the same one more than once.
-				if (thisMod->friend_getDoneFlag() == theIterFlag)
+				if (context.checkAndMarkDone(thisMod))
 					continue;
-				thisMod->friend_setDoneFlag(theIterFlag);
 			
 				Real thisDistSqr;
 				Coord3D distVec;
@@ -3361,8 +3517,7 @@ Object *PartitionManager::getClosestObjects(
 
 	Bool foundAny = false;
 
-	static Int theIterFlag = 1;	// nonzero, thanks
-	++theIterFlag;
+	GCOQueryContext context;
 
 	PartitionCell *thisCell;
 	while ((thisCell = iter.nextNonEmpty()) != NULL)
@@ -3380,15 +3535,13 @@ Object *PartitionManager::getClosestObjects(
 			if (thisObj == obj) 
 				continue;
 
-			if (thisMod->friend_getDoneFlag() == theIterFlag)
+			if (context.checkAndMarkDone(thisMod))
 				continue;
-
-			thisMod->friend_setDoneFlag(theIterFlag);
 		
 			// hmm, ok, calc the distance.
 			Real thisDistSqr;
 			Coord3D distVec;
-			if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, &thisDistSqr, &distVec, closestDistSqr))
+			if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, thisDistSqr, distVec, closestDistSqr))
 				continue;
 
 			// check the filters now
@@ -3431,9 +3584,6 @@ Object *PartitionManager::getClosestObjects(
 		*closestDistArg = (Real)sqrtf(closestDistSqr);
 	}
 
-#ifdef _DEBUG
-	--theEntrancyCount;
-#endif
 #ifdef DUMP_PERF_STATS
 	Int64 endTime64;
 	GetPrecisionTimer(&endTime64);
@@ -4758,19 +4908,22 @@ void PartitionManager::getMostValuableLocation( Int playerIndex, UnsignedInt whi
 		allPlayerMasks[i] = player->getPlayerMask();
 	}
 
+	// pick out the planes we're summing up front, then walk them all in step.
+	const Int* planes[MAX_PLAYER_COUNT];
+	Int planeCount = 0;
+	for (Int player = 0; player < MAX_PLAYER_COUNT; ++player) {
+		if (BitTestWW(allPlayerMasks[player], playerMask)) {
+			planes[planeCount++] = (valType == VOT_CashValue) ? getCashPlane(player) : getThreatPlane(player);
+		}
+	}
+
 	Int greatestValueCell = -1;
 	Int maxCellValue = -1;
 	for (i = 0; i < cellCount; ++i) {
 		Int cellValue = 0;
 
-		for (Int player = 0; player < MAX_PLAYER_COUNT; ++player) {
-			if (BitTestWW(allPlayerMasks[player], playerMask)) {
-				if (valType == VOT_CashValue) {
-					cellValue += m_cells[i].getCashValue(player);
-				} else {
-					cellValue += m_cells[i].getThreatValue(player);
-				}
-			}
+		for (Int plane = 0; plane < planeCount; ++plane) {
+			cellValue += planes[plane][i];
 		}
 
 		if (cellValue > maxCellValue) {
@@ -4856,15 +5009,17 @@ void PartitionManager::storeFoggedCells(ShroudStatusStoreRestore &outPartitionSt
 			continue;
 		}
 
+		const ShroudLevel* levels = getShroudPlane(p);
 		for (j = 0; j < m_cellCountY; ++j) {
 			for (i = 0; i < m_cellCountX; ++i) {
 				UnsignedByte &byteToWrite = outPartitionStore.m_foggedOrRevealed[p][j * m_cellCountX + i]; 
+				CellShroudStatus status = shroudStatusFromLevel(levels[j * m_cellCountX + i]);
 
-				if (storeToFog && m_cells[j * m_cellCountX + i].getShroudStatusForPlayer(p) == CELLSHROUD_FOGGED) {
+				if (storeToFog && status == CELLSHROUD_FOGGED) {
 					byteToWrite = STORE_FOG;
 				}
 					
-				if (!storeToFog && m_cells[j * m_cellCountX + i].getShroudStatusForPlayer(p) == CELLSHROUD_CLEAR) {
+				if (!storeToFog && status == CELLSHROUD_CLEAR) {
 					byteToWrite = STORE_PERMANENTLY_REVEALED;
 				}
 			}
@@ -5598,183 +5753,143 @@ static int cellValueProc(PartitionCell* cell, void* userData)
 }
 
 // -----------------------------------------------------------------------------
-static void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
+// The DiscreteCircle callbacks. Each one clips its row span to the map once, and then hands a 
+// run of contiguous cells in one player's plane to a span kernel.
+// -----------------------------------------------------------------------------
+static inline Bool clipSpanToMap(Int& x1, Int& x2, Int y, Int cellCountX, Int cellCountY)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
-		return;
+	if (y < 0 || y >= cellCountY || x1 >= cellCountX || x2 < 0)
+		return false;
 
-	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
+	if (x1 < 0)
+		x1 = 0;
+	if (x2 >= cellCountX)
+		x2 = cellCountX - 1;
+	return true;
+}
 
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
+// -----------------------------------------------------------------------------
+static inline UnsignedInt calcThreatOrValueAt(Int x, Int y, const ThreatValueParms *parms)
+{
+	Real distance = sqrt( pow(x - parms->xCenter, 2) + pow(y - parms->yCenter, 2) );
+	Real mulVal = 1 - distance / parms->radius;
+	if (mulVal < 0.0f) 
+		mulVal = 0.0f;
+	else if (mulVal > 1.0f)
+		mulVal = 1.0f;
+
+	return REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal);
+}
+
+// -----------------------------------------------------------------------------
+/** add (sign > 0) or remove (sign < 0) the falloff'ed threat-or-value to cells x1..x2 of 'row',
+	* which is row y of one player's threat or cash plane. */
+// -----------------------------------------------------------------------------
+static inline void threatOrValueSpanKernel(Int *row, Int x1, Int x2, Int y, const ThreatValueParms *parms, Int sign)
+{
+	DEBUG_ASSERTCRASH(parms->playerIndex >= 0 && parms->playerIndex < MAX_PLAYER_COUNT, ("bad player index"));
+	for (Int x = x1; x <= x2; ++x)
 	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->addLooker(playerIndex);
+		UnsignedInt amount = calcThreatOrValueAt(x, y, parms);
+#ifdef _DEBUG
+		UnsignedInt oldVal = row[x];
+		DEBUG_ASSERTCRASH(sign > 0 ? (oldVal <= oldVal + amount) : (oldVal >= oldVal - amount), ("threat/cash value over/underflowed allotted storage."));
+#endif
+		if (sign > 0)
+			row[x] += amount;
+		else
+			row[x] -= amount;
 	}
 }
 
 // -----------------------------------------------------------------------------
-static void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
+static void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
+	Int first = y * ThePartitionManager->m_cellCountX + x1;
+	shroudSpanKernel<applyAddLooker>(ThePartitionManager->getShroudPlane(playerIndex) + first, ThePartitionManager->m_cells + first, x2 - x1 + 1, playerIndex);
+}
 
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->removeLooker(playerIndex);
-	}
+// -----------------------------------------------------------------------------
+static void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
+{
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
+		return;
+
+	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
+	Int first = y * ThePartitionManager->m_cellCountX + x1;
+	shroudSpanKernel<applyRemoveLooker>(ThePartitionManager->getShroudPlane(playerIndex) + first, ThePartitionManager->m_cells + first, x2 - x1 + 1, playerIndex);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineAddShrouder(Int x1, Int x2, Int y, void *playerIndexVoid)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->addShrouder( playerIndex );
-	}
+	Int first = y * ThePartitionManager->m_cellCountX + x1;
+	shroudSpanKernel<applyAddShrouder>(ThePartitionManager->getShroudPlane(playerIndex) + first, ThePartitionManager->m_cells + first, x2 - x1 + 1, playerIndex);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineRemoveShrouder(Int x1, Int x2, Int y, void *playerIndexVoid)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
+	// removing a shrouder never changes anyone's status, so there's no edge trigger to look for.
 	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->removeShrouder( playerIndex );
-	}
+	ShroudLevel* levels = ThePartitionManager->getShroudPlane(playerIndex) + y * ThePartitionManager->m_cellCountX;
+	for (Int x = x1; x <= x2; ++x)
+		applyRemoveShrouder(levels[x]);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineAddThreat(Int x1, Int x2, Int y, void *threatValueParms)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	ThreatValueParms *parms = (ThreatValueParms*)threatValueParms;
-
-	Real distance;
-	Real mulVal = 1.0f;
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-
-		distance = sqrt( pow(x - parms->xCenter, 2) + pow(y - parms->yCenter, 2) );
-		mulVal = 1 - distance / parms->radius;
-		if (mulVal < 0.0f) 
-			mulVal = 0.0f;
-		else if (mulVal > 1.0f)
-			mulVal = 1.0f;
-
-		cell->addThreatValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
-	}
+	Int *row = ThePartitionManager->getThreatPlane(parms->playerIndex) + y * ThePartitionManager->m_cellCountX;
+	threatOrValueSpanKernel(row, x1, x2, y, parms, 1);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineRemoveThreat(Int x1, Int x2, Int y, void *threatValueParms)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	ThreatValueParms *parms = (ThreatValueParms*)threatValueParms;
-
-	Real distance;
-	Real mulVal = 1.0f;
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-
-		distance = sqrt( pow(x - parms->xCenter, 2) + pow(y - parms->yCenter, 2) );
-		mulVal = 1 - distance / parms->radius;
-		if (mulVal < 0.0f) 
-			mulVal = 0.0f;
-		else if (mulVal > 1.0f)
-			mulVal = 1.0f;
-		
-		cell->removeThreatValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
-	}
+	Int *row = ThePartitionManager->getThreatPlane(parms->playerIndex) + y * ThePartitionManager->m_cellCountX;
+	threatOrValueSpanKernel(row, x1, x2, y, parms, -1);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineAddValue(Int x1, Int x2, Int y, void *threatValueParms)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	ThreatValueParms *parms = (ThreatValueParms*)threatValueParms;
-
-	Real distance;
-	Real mulVal = 1.0f;
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-
-		distance = sqrt( pow(x - parms->xCenter, 2) + pow(y - parms->yCenter, 2) );
-		mulVal = 1 - distance / parms->radius;
-		if (mulVal < 0.0f) 
-			mulVal = 0.0f;
-		else if (mulVal > 1.0f)
-			mulVal = 1.0f;
-		
-		cell->addCashValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
-	}
+	Int *row = ThePartitionManager->getCashPlane(parms->playerIndex) + y * ThePartitionManager->m_cellCountX;
+	threatOrValueSpanKernel(row, x1, x2, y, parms, 1);
 }
 
 // -----------------------------------------------------------------------------
 static void hLineRemoveValue(Int x1, Int x2, Int y, void *threatValueParms)
 {
-	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
+	if (!clipSpanToMap(x1, x2, y, ThePartitionManager->m_cellCountX, ThePartitionManager->m_cellCountY))
 		return;
 
 	ThreatValueParms *parms = (ThreatValueParms*)threatValueParms;
-
-	Real distance;
-	Real mulVal = 1.0f;
-
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
-	for (Int x = x1; x <= x2; ++x, ++cell)
-	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-
-		distance = sqrt( pow(x - parms->xCenter, 2) + pow(y - parms->yCenter, 2) );
-		mulVal = 1 - distance / parms->radius;
-		if (mulVal < 0.0f) 
-			mulVal = 0.0f;
-		else if (mulVal > 1.0f)
-			mulVal = 1.0f;
-
-		cell->removeCashValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
-	}
+	Int *row = ThePartitionManager->getCashPlane(parms->playerIndex) + y * ThePartitionManager->m_cellCountX;
+	threatOrValueSpanKernel(row, x1, x2, y, parms, -1);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -79,6 +79,16 @@
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
+//-------------------------------------------------------------------------------------------------
+/** Player issued moves get their paths before AI & script moves.  Delayed re-paths are queued
+	on the idle lane directly (see AIUpdateInterface::update). */
+static PathfindQueuePriority getPathfindQueuePriority( const AIUpdateInterface *ai )
+{
+	if (ai->getLastCommandSource() == CMD_FROM_PLAYER)
+		return PATHFIND_PRIORITY_PLAYER;
+	return PATHFIND_PRIORITY_AI;
+}
+
 //-------------------------------------------------------------------------------------------------
 AIUpdateModuleData::AIUpdateModuleData()
 {
@@ -518,7 +528,7 @@ void AIUpdateInterface::requestPath( Coord3D *destination, Bool isFinalGoal )
 		}
 		return;
 	}
-	TheAI->pathfinder()->queueForPath(getObject()->getID());
+	TheAI->pathfinder()->queueForPath(getObject()->getID(), getPathfindQueuePriority(this));
 
 }
 
@@ -542,7 +552,7 @@ void AIUpdateInterface::requestAttackPath( ObjectID victimID, const Coord3D* vic
 		setLocomotorGoalNone();
 		return;
 	}
-	TheAI->pathfinder()->queueForPath(getObject()->getID());
+	TheAI->pathfinder()->queueForPath(getObject()->getID(), getPathfindQueuePriority(this));
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -565,7 +575,7 @@ void AIUpdateInterface::requestApproachPath( Coord3D *destination )
 		setQueueForPathTime(2*LOGICFRAMES_PER_SECOND);
 		return;
 	}
-	TheAI->pathfinder()->queueForPath(getObject()->getID());
+	TheAI->pathfinder()->queueForPath(getObject()->getID(), getPathfindQueuePriority(this));
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -589,7 +599,7 @@ void AIUpdateInterface::requestSafePath( ObjectID repulsor )
 		setQueueForPathTime(2*LOGICFRAMES_PER_SECOND);
 		return;
 	}
-	TheAI->pathfinder()->queueForPath(getObject()->getID());
+	TheAI->pathfinder()->queueForPath(getObject()->getID(), getPathfindQueuePriority(this));
 }
 
 enum {WAYPOINT_PATH_LIMIT=1024};
@@ -1073,7 +1083,7 @@ UpdateSleepTime AIUpdateInterface::update( void )
 	{
 		if (now >= m_queueForPathFrame) 
 		{
-			TheAI->pathfinder()->queueForPath(getObject()->getID());
+			TheAI->pathfinder()->queueForPath(getObject()->getID(), PATHFIND_PRIORITY_IDLE);
 			setQueueForPathTime(0);
 		}
 		else
@@ -41,6 +41,7 @@
 #include "Common/Team.h"
 #include "Common/ThingFactory.h"
 #include "Common/ThingTemplate.h"
+#include "Common/WellKnownKeys.h"
 #include "Common/Xfer.h"
 
 #include "GameClient/MessageBox.h"
@@ -130,6 +131,24 @@ enum { K_SCRIPTS_DATA_VERSION_1 = 1 };
 enum { MAX_SPIN_COUNT = 20 };
 #define NONE_STRING "<none>"
 
+// Uncomment to evaluate every script whose cached condition result would be used, and crash if they differ.
+//#define VERIFY_SCRIPT_CONDITION_CACHE
+
+// Timer for script profiling.  Works in release builds, so -profileScripts does too.
+static Int64 st_profileTicksPerSecond = 1;
+
+static inline Int64 getScriptProfileTicks( void )
+{
+	Int64 ticks;
+	QueryPerformanceCounter((LARGE_INTEGER *)&ticks);
+	return ticks;
+}
+
+static inline Real scriptProfileSeconds( Int64 ticks )
+{
+	return (Real)((double)ticks / (double)st_profileTicksPerSecond);
+}
+
 static const Int FRAMES_TO_SHOW_WIN_LOSE_MESSAGE = 120;
 
 static const Int FRAMES_TO_FADE_IN_AT_START = 33;
@@ -471,8 +490,10 @@ m_minFade(0.0f),
 m_numAttackInfo(0),
 m_shownMPLocalDefeatWindow(FALSE),
 m_objectsShouldReceiveDifficultyBonus(TRUE),
-m_ChooseVictimAlwaysUsesNormal(false)
+m_ChooseVictimAlwaysUsesNormal(false),
 //
+m_profiling(FALSE),
+m_profileFrames(0)
 {
 	st_CanAppCont = true;
 	st_LastCurrentFrame = st_CurrentFrame = 0;
@@ -531,6 +552,9 @@ ScriptEngine::~ScriptEngine()
 //-------------------------------------------------------------------------------------------------
 void ScriptEngine::init( void )
 {
+	QueryPerformanceFrequency((LARGE_INTEGER *)&st_profileTicksPerSecond);
+	m_profiling = TheGlobalData->m_profileScripts;
+
 	if (TheGlobalData->m_windowed)
 		if (TheGlobalData->m_scriptDebug) {
 			st_DebugDLL = LoadLibrary("DebugWindow.dll");
@@ -5275,6 +5299,10 @@ void ScriptEngine::init( void )
 //-------------------------------------------------------------------------------------------------
 void ScriptEngine::reset( void )
 {
+	// The map is going away, so this is the last chance to report on its scripts.
+	writeScriptProfile();
+	clearScriptProfile();
+
 	// setting FPS limit in case a script had changed it
 	if (TheGameEngine && TheGlobalData)
 		TheGameEngine->setFramesPerSecondLimit(TheGlobalData->m_framesPerSecondLimit);
@@ -5602,7 +5630,14 @@ void ScriptEngine::update( void )
 	m_uiInteractions.clear();
 
 	// update all sequential stuff.
-	evaluateAndProgressAllSequentialScripts();
+	if (m_profiling) {
+		Int64 startTime = getScriptProfileTicks();
+		evaluateAndProgressAllSequentialScripts();
+		m_sequentialScriptProfile.addSample(scriptProfileSeconds(getScriptProfileTicks() - startTime));
+		m_profileFrames++;
+	} else {
+		evaluateAndProgressAllSequentialScripts();
+	}
 
 	// Script debugger stuff
 	st_CurrentFrame++;
@@ -5698,6 +5733,138 @@ AsciiString ScriptEngine::getStats(Real *curTimePtr, Real *script1Time, Real *sc
 	return msg;
 }  // end getStats
 
+//-------------------------------------------------------------------------------------------------
+/** Execute a script's true or false actions, timing them if we are profiling.  The time includes
+		any subroutines the actions call. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::executeScriptActions( Script *pScript, ScriptAction *pActionHead )
+{
+	if (!m_profiling) {
+		executeActions(pActionHead);
+		return;
+	}
+	Int64 startTime = getScriptProfileTicks();
+	executeActions(pActionHead);
+	pScript->addActionProfileSample(scriptProfileSeconds(getScriptProfileTicks() - startTime));
+}
+
+//-------------------------------------------------------------------------------------------------
+/** clearScriptProfile */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::clearScriptProfile( void )
+{
+	m_profileFrames = 0;
+	m_sequentialScriptProfile.clear();
+	Int i;
+	for (i=0; i<Condition::NUM_ITEMS; i++) {
+		m_conditionTypeProfile[i].clear();
+	}
+	if (!TheSidesList) {
+		return;
+	}
+	for (i=0; i<TheSidesList->getNumSides(); i++) {
+		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
+		if (!pSL) continue;
+		Script *pScr;
+		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
+			pScr->clearProfile();
+		}
+		ScriptGroup *pGroup;
+		for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
+				pScr->clearProfile();
+			}
+		}
+	}
+}
+
+// Map authors name things freely; keep their names from breaking the csv quoting.
+static AsciiString csvField( const AsciiString& str )
+{
+	AsciiString field;
+	for (const char *c = str.str(); *c; c++) {
+		field.concat(*c == '"' ? '\'' : *c);
+	}
+	return field;
+}
+
+static void writeScriptProfileRow( FILE *fp, const char *kind, const AsciiString& side, const AsciiString& group, 
+																	 const AsciiString& name, const ScriptProfileStat& stat )
+{
+	if (stat.m_count == 0) {
+		return;
+	}
+	fprintf(fp, "%s,\"%s\",\"%s\",\"%s\",%d,%.3f,%.3f,%.4f\n", kind, 
+		csvField(side).str(), csvField(group).str(), csvField(name).str(), stat.m_count,
+		1000*stat.m_totalTime, 1000*stat.m_maxTime, 1000*stat.m_totalTime/stat.m_count);
+}
+
+static void writeScriptProfileRows( FILE *fp, const AsciiString& side, const AsciiString& group, Script *pScr )
+{
+	for (; pScr; pScr=pScr->getNext()) {
+		writeScriptProfileRow(fp, "Conditions", side, group, pScr->getName(), pScr->getConditionProfile());
+		writeScriptProfileRow(fp, "Actions", side, group, pScr->getName(), pScr->getActionProfile());
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Write what -profileScripts collected for the map that is ending to 
+		<user data>\ScriptProfile_<map>.csv.  Everything is one table, one row per script (conditions 
+		and actions separately), per condition type, and for the sequential scripts, so it can be 
+		sorted by whichever column you're interested in.  Times are in milliseconds. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::writeScriptProfile( void )
+{
+	if (!m_profiling || m_profileFrames == 0) {
+		return;
+	}
+
+	AsciiString mapName = TheGlobalData->m_mapName;
+	const char *leaf = mapName.reverseFind('\\');
+	if (!leaf) leaf = mapName.reverseFind('/');
+	AsciiString leafName = leaf ? leaf+1 : mapName.str();
+	if (leafName.endsWithNoCase(".map")) {
+		for (Int c=0; c<4; c++) {
+			leafName.removeLastChar();
+		}
+	}
+	if (leafName.isEmpty()) {
+		leafName = "Unknown";
+	}
+
+	AsciiString fileName;
+	fileName.format("%sScriptProfile_%s.csv", TheGlobalData->getPath_UserData().str(), leafName.str());
+	FILE *fp = fopen(fileName.str(), "w");
+	if (fp == NULL) {
+		DEBUG_CRASH(("Could not open script profile file %s.\n", fileName.str()));
+		return;
+	}
+
+	fprintf(fp, "Kind,Side,Group,Name,Count,TotalMsec,MaxMsec,AvgMsec\n");
+	fprintf(fp, "Frames,\"\",\"\",\"%s\",%d,,,\n", csvField(leafName).str(), m_profileFrames);
+	writeScriptProfileRow(fp, "Sequential", AsciiString::TheEmptyString, AsciiString::TheEmptyString, 
+		"evaluateAndProgressAllSequentialScripts", m_sequentialScriptProfile);
+	Int i;
+	for (i=0; i<Condition::NUM_ITEMS; i++) {
+		writeScriptProfileRow(fp, "ConditionType", AsciiString::TheEmptyString, AsciiString::TheEmptyString, 
+			m_conditionTemplates[i].m_internalName, m_conditionTypeProfile[i]);
+	}
+	if (TheSidesList) {
+		for (i=0; i<TheSidesList->getNumSides(); i++) {
+			ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
+			if (!pSL) continue;
+			AsciiString side = TheSidesList->getSideInfo(i)->getDict()->getAsciiString(TheKey_playerName);
+			writeScriptProfileRows(fp, side, AsciiString::TheEmptyString, pSL->getScript());
+			ScriptGroup *pGroup;
+			for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+				writeScriptProfileRows(fp, side, pGroup->getName(), pGroup->getScript());
+			}
+		}
+	}
+	fclose(fp);
+	DEBUG_LOG(("Wrote script profile for %d frames to %s\n", m_profileFrames, fileName.str()));
+}
+
 //-------------------------------------------------------------------------------------------------
 /** startQuickEndGameTimer */
 //-------------------------------------------------------------------------------------------------
@@ -6988,7 +7155,7 @@ void ScriptEngine::executeScript( Script *pScript )
 	TeamPrototype *pProto = NULL;
 
 	if (!pScript->getConditionTeamName().isEmpty()) {
-		pProto = TheTeamFactory->findTeamPrototype(pScript->getConditionTeamName());
+		pProto = pScript->getConditionTeamPrototype();
 	}
 
 	if (pProto && pProto->countTeamInstances() > 0) {
@@ -7001,7 +7168,7 @@ void ScriptEngine::executeScript( Script *pScript )
 				// Script Debug window
 				if (pScript->getAction()) {
 					_appendMessage(pScript->getName());
-					executeActions(pScript->getAction());
+					executeScriptActions(pScript, pScript->getAction());
 				}
 				
 				if (pScript->isOneShot()) {
@@ -7013,7 +7180,7 @@ void ScriptEngine::executeScript( Script *pScript )
 				_appendMessage(pScript->getName(), false);
 
 				// Only do this is there are actually false actions.
-				executeActions(pScript->getFalseAction());
+				executeScriptActions(pScript, pScript->getFalseAction());
       } 
 		}
 
@@ -7024,7 +7191,7 @@ void ScriptEngine::executeScript( Script *pScript )
 			if (pScript->getAction()) {
 				// Script Debug window
 				_appendMessage(pScript->getName());
-				executeActions(pScript->getAction());
+				executeScriptActions(pScript, pScript->getAction());
 			}
 
 			if (pScript->isOneShot()) {
@@ -7036,7 +7203,7 @@ void ScriptEngine::executeScript( Script *pScript )
 			_appendMessage(pScript->getName(), false);
 
 			// Only do this is there are actually false actions.
-			executeActions(pScript->getFalseAction());
+			executeScriptActions(pScript, pScript->getFalseAction());
 			if (pScript->isOneShot()) {
 				pScript->setActive(false);
 			}
@@ -7585,44 +7752,151 @@ Bool ScriptEngine::evaluateConditions( Script *pScript, Team *thisTeam, Player *
 	if (thisTeam) player = thisTeam->getControllingPlayer();
 	if (player==NULL) player=m_currentPlayer;
 	LatchRestore<Player*> latch2(m_currentPlayer, player);
-	OrCondition *pConditionHead = pScript->getOrCondition();
-	Bool testValue = false;
+	Int numSteps;
+	pScript->getCompiledConditions(&numSteps);	// builds them if need be.
+	CompiledCondition *steps = pScript->friend_getCompiledConditions();
+	Bool cacheable = pScript->areConditionsCacheable();
+
+	if (cacheable && pScript->hasCachedResult() && conditionReadsUnchanged(steps, numSteps)) {
+		// Nothing the conditions looked at last time has changed, so neither has the answer.
+		Bool verify = pScript->isVerifyingCachedResult();
+#ifdef VERIFY_SCRIPT_CONDITION_CACHE
+		verify = true;
+#endif
+		if (!verify) {
+			return pScript->getCachedResult();
+		}
+		Bool fullValue = evaluateCompiledConditions(steps, numSteps, false);
+		DEBUG_ASSERTCRASH(fullValue == pScript->getCachedResult(), ("Cached condition result for script '%s' is stale.\n", pScript->getName().str()));
+		return fullValue;
+	}
 
+	Bool collectTimes = m_profiling;
 #ifdef DEBUG_LOGGING
-#define COLLECT_CONDITION_EVAL_TIMES
-#endif
-#ifdef COLLECT_CONDITION_EVAL_TIMES
-	__int64 startTime64;
-	Real timeToEvaluate=0.0f;
-	__int64 endTime64,freq64;
-	QueryPerformanceFrequency((LARGE_INTEGER *)&freq64);
-	QueryPerformanceCounter((LARGE_INTEGER *)&startTime64);
+	collectTimes = true;	// the SPECIAL_SCRIPT_PROFILING dump in reset() uses the condition times.
 #endif
-	OrCondition *pCurCondition;
-	for (pCurCondition = pConditionHead; pCurCondition; pCurCondition = pCurCondition->getNextOrCondition()) {
-		Condition *pCondition = pCurCondition->getFirstAndCondition();
-		if (!pCondition) continue; // No conditions, so go to the next or.
-		Bool andTerm = true; 
-		while (pCondition && andTerm) {
-			if (!evaluateCondition(pCondition)) {
-				andTerm = false;
-				break; // Short circuit the and evauation - after the first false, we can quit.
-			}
-			pCondition = pCondition->getNext();
+	Int64 startTime = 0;
+	if (collectTimes) {
+		startTime = getScriptProfileTicks();
+	}
+	Bool testValue = evaluateCompiledConditions(steps, numSteps, cacheable);
+	if (collectTimes) {
+		Real timeToEvaluate = scriptProfileSeconds(getScriptProfileTicks() - startTime);
+		pScript->incrementConditionCount();
+		pScript->addToConditionTime(timeToEvaluate);
+		pScript->addConditionProfileSample(timeToEvaluate);
+	}
+
+	if (cacheable) {
+		// A pending ui interaction can make a flag test true regardless of the flag, and goes
+		// away at the end of the frame, so don't remember results that might have used one.
+		if (m_uiInteractions.empty()) {
+			pScript->setCachedResult(testValue);
+		} else {
+			pScript->clearCachedResult();
 		}
-		if (andTerm) { // The outer list is OR'ed - so any true inner means we are true.
-			testValue = true;
-			break;
+	}
+
+	return testValue;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Walk the compiled conditions.  If snapshotReads is set, record what each step we reach
+		reads so conditionReadsUnchanged can tell later if the result could be different. */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::evaluateCompiledConditions( CompiledCondition *steps, Int numSteps, Bool snapshotReads )
+{
+	if (snapshotReads) {
+		for (Int i = 0; i < numSteps; i++) {
+			steps[i].m_readEvaluated = false;
 		}
 	}
-#ifdef COLLECT_CONDITION_EVAL_TIMES
-	QueryPerformanceCounter((LARGE_INTEGER *)&endTime64);
-	timeToEvaluate = ((Real)(endTime64-startTime64) / (Real)(freq64));
-	pScript->incrementConditionCount();
-	pScript->addToConditionTime(timeToEvaluate);
-#endif
+	// The outer list is OR'ed, the inner lists AND'ed.  A false step short circuits to the
+	// next or clause; getting through the last step of a clause means we are true.
+	Int step = 0;
+	while (step < numSteps) {
+		Bool value;
+		if (m_profiling) {
+			Int64 startTime = getScriptProfileTicks();
+			value = evaluateCondition(steps[step].m_condition);
+			m_conditionTypeProfile[steps[step].m_condition->getConditionType()].addSample(scriptProfileSeconds(getScriptProfileTicks() - startTime));
+		} else {
+			value = evaluateCondition(steps[step].m_condition);
+		}
+		if (snapshotReads) {
+			snapshotConditionReads(&steps[step]);
+		}
+		if (!value) {
+			step = steps[step].m_onFalse;
+		} else if (steps[step].m_endsAndTerm) {
+			return true;
+		} else {
+			step++;
+		}
+	}
+	return false; // If none of the or's fired, then it is false.
+}
 
-	return testValue; // If none of the or's fired, then it is false.
+//-------------------------------------------------------------------------------------------------
+/** Record the state a just evaluated step looked at. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::snapshotConditionReads( CompiledCondition *step )
+{
+	step->m_readEvaluated = true;
+	switch (step->m_reads) {
+		case CompiledCondition::READS_COUNTER:
+			// evaluateCounter/evaluateTimer allocated the counter if need be.
+			step->m_readIndex = step->m_condition->getParameter(0)->getInt();
+			step->m_readValue = m_counters[step->m_readIndex].value;
+			step->m_readTimerRunning = m_counters[step->m_readIndex].isCountdownTimer;
+			break;
+		case CompiledCondition::READS_FLAG:
+			step->m_readIndex = step->m_condition->getParameter(0)->getInt();
+			step->m_readValue = m_flags[step->m_readIndex].value;
+			break;
+		case CompiledCondition::READS_OBJECT_COUNT:
+			step->m_readValue = step->m_condition->getCustomData();
+			break;
+		default:
+			break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** True if every step reached in the last evaluation would give the same answer now.  Since
+		the same answers take the same path, the steps that weren't reached still won't be. */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::conditionReadsUnchanged( const CompiledCondition *steps, Int numSteps )
+{
+	for (Int i = 0; i < numSteps; i++) {
+		const CompiledCondition &step = steps[i];
+		if (!step.m_readEvaluated) {
+			continue;
+		}
+		switch (step.m_reads) {
+			case CompiledCondition::READS_NOTHING:
+				break;
+			case CompiledCondition::READS_COUNTER:
+				if (step.m_condition->getParameter(0)->getInt() != step.m_readIndex) return false;
+				if (m_counters[step.m_readIndex].value != step.m_readValue) return false;
+				if (m_counters[step.m_readIndex].isCountdownTimer != step.m_readTimerRunning) return false;
+				break;
+			case CompiledCondition::READS_FLAG:
+				if (!m_uiInteractions.empty()) return false;
+				if (step.m_condition->getParameter(0)->getInt() != step.m_readIndex) return false;
+				if (m_flags[step.m_readIndex].value != step.m_readValue) return false;
+				break;
+			case CompiledCondition::READS_OBJECT_COUNT:
+				// Same test the condition uses to decide whether its own cached value is good.
+				if (step.m_condition->getCustomData() == 0) return false;
+				if (step.m_condition->getCustomData() != step.m_readValue) return false;
+				if (step.m_condition->getCustomFrame() != (Int)m_frameObjectCountChanged) return false;
+				break;
+			default:
+				return false;
+		}
+	}
+	return true;
 }
 
 
@@ -54,6 +54,7 @@
 #include "Common/GameState.h"
 #include "Common/KindOf.h"
 #include "Common/Radar.h"
+#include "Common/Team.h"
 #include "Common/ThingTemplate.h"
 #include "Common/Player.h"
 #include "Common/Xfer.h"
@@ -926,8 +927,16 @@ m_action(NULL),
 //Added By Sadullah Nader
 //Initializations inserted
 m_actionFalse(NULL),
-m_curTime(0.0f)
+m_curTime(0.0f),
 //
+m_compiledConditions(NULL),
+m_numCompiledConditions(0),
+m_conditionTeamPrototype(NULL),
+m_conditionTeamGeneration(0),
+m_conditionsCacheable(false),
+m_hasCachedResult(false),
+m_cachedResult(false),
+m_verifyCachedResult(false)
 {
 }
 
@@ -957,6 +966,7 @@ Script::~Script(void)
 	if (m_actionFalse) {
 		m_actionFalse->deleteInstance();
 	}
+	invalidateCompiledConditions();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1096,6 +1106,8 @@ void Script::updateFrom(Script *pSrc)
 	}
 	this->m_condition = pSrc->m_condition;
 	pSrc->m_condition = NULL;
+	this->invalidateCompiledConditions();
+	pSrc->invalidateCompiledConditions();
 	if (this->m_action) {
 		this->m_action->deleteInstance();
 	}
@@ -1128,6 +1140,121 @@ void Script::deleteOrCondition(OrCondition *pCond)
 	}
 	pCur->setNextOrCondition(NULL);
 	pCur->deleteInstance();
+	invalidateCompiledConditions();
+}
+
+/**
+  classifyConditionReads - what a condition's result depends on.  Only conditions whose
+	result is a function of script engine state (or that cache their own result until the
+	object count changes, independent of which team or player is evaluating them) are
+	classified; everything else is READS_UNKNOWN.
+*/
+static CompiledCondition::Reads classifyConditionReads(const Condition *pCond)
+{
+	switch (pCond->getConditionType()) {
+		case Condition::CONDITION_FALSE:
+		case Condition::CONDITION_TRUE:
+			return CompiledCondition::READS_NOTHING;
+		case Condition::COUNTER:
+		case Condition::TIMER_EXPIRED:
+			return CompiledCondition::READS_COUNTER;
+		case Condition::FLAG:
+			return CompiledCondition::READS_FLAG;
+		case Condition::BUILT_BY_PLAYER:
+		case Condition::PLAYER_HAS_OBJECT_COMPARISON:
+			return CompiledCondition::READS_OBJECT_COUNT;
+		default:
+			return CompiledCondition::READS_UNKNOWN;
+	}
+}
+
+/**
+  Script::compileConditions - flatten the or/and condition lists into m_compiledConditions.
+	Each and term becomes a run of steps; a false step jumps to the start of the next run,
+	and a true step at the end of a run means the whole script is true.  Empty and terms
+	can never be true, so they are dropped.
+*/
+void Script::compileConditions(void)
+{
+	invalidateCompiledConditions();
+
+	Int count = 0;
+	OrCondition *pOr;
+	Condition *pCond;
+	for (pOr = m_condition; pOr; pOr = pOr->getNextOrCondition()) {
+		for (pCond = pOr->getFirstAndCondition(); pCond; pCond = pCond->getNext()) {
+			count++;
+		}
+	}
+
+	// always allocate at least one step, so that a script with no conditions is still "compiled".
+	m_compiledConditions = NEW CompiledCondition[count > 0 ? count : 1];
+	m_numCompiledConditions = count;
+
+	m_conditionsCacheable = true;
+	Int step = 0;
+	for (pOr = m_condition; pOr; pOr = pOr->getNextOrCondition()) {
+		Int runStart = step;
+		for (pCond = pOr->getFirstAndCondition(); pCond; pCond = pCond->getNext()) {
+			CompiledCondition &cc = m_compiledConditions[step];
+			cc.m_condition = pCond;
+			cc.m_endsAndTerm = (pCond->getNext() == NULL);
+			cc.m_reads = classifyConditionReads(pCond);
+			cc.m_readEvaluated = false;
+			cc.m_readIndex = 0;
+			cc.m_readValue = 0;
+			cc.m_readTimerRunning = false;
+			if (cc.m_reads == CompiledCondition::READS_UNKNOWN) {
+				m_conditionsCacheable = false;
+			}
+			step++;
+		}
+		for (Int i = runStart; i < step; i++) {
+			m_compiledConditions[i].m_onFalse = step;
+		}
+	}
+	DEBUG_ASSERTCRASH(step == count, ("Condition count changed while compiling script %s.", m_scriptName.str()));
+}
+
+/**
+  Script::getCompiledConditions - returns the flattened conditions, building them if need be.
+*/
+const CompiledCondition *Script::getCompiledConditions(Int *count)
+{
+	if (m_compiledConditions == NULL) {
+		compileConditions();
+	}
+	*count = m_numCompiledConditions;
+	return m_compiledConditions;
+}
+
+/**
+  Script::invalidateCompiledConditions - throw away the flattened conditions.  Anything that 
+	edits the condition lists must call this (or go through a Script method that does).
+*/
+void Script::invalidateCompiledConditions(void)
+{
+	if (m_compiledConditions) {
+		delete [] m_compiledConditions;
+		m_compiledConditions = NULL;
+	}
+	m_numCompiledConditions = 0;
+	m_conditionsCacheable = false;
+	m_hasCachedResult = false;
+}
+
+/**
+  Script::getConditionTeamPrototype - the prototype for m_conditionTeamName, or NULL.  The
+	lookup is redone only when the team factory adds or removes prototypes.
+*/
+TeamPrototype *Script::getConditionTeamPrototype(void)
+{
+	UnsignedInt generation = TheTeamFactory->getPrototypeGeneration();
+	if (m_conditionTeamGeneration != generation) {
+		m_conditionTeamPrototype = TheTeamFactory->findTeamPrototype(m_conditionTeamName);
+		m_conditionTeamGeneration = generation;
+	}
+	return m_conditionTeamPrototype;
 }
 
 
@@ -112,6 +112,10 @@
 
 #include <rts/profile.h>
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+#include <psapi.h>
+#endif
+
 DECLARE_PERF_TIMER(SleepyMaintenance)
 
 #include "Common/UnitTimings.h" //Contains the DO_UNIT_TIMINGS define jba.		 
@@ -146,6 +150,35 @@ enum { OBJ_HASH_SIZE	= 8192 };
 GameLogic *TheGameLogic = NULL;
 
 static void findAndSelectCommandCenter(Object *obj, void* alreadyFound);
+static Bool getMapDirectory( AsciiString mapName, char *filename );
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+// ------------------------------------------------------------------------------------------------
+/** Peak working set of the process so far, in KB, or 0 if it can't be had.  psapi is loaded
+	* by hand so the game doesn't link against it just for a debug log. */
+// ------------------------------------------------------------------------------------------------
+static Int getPeakWorkingSetKB( void )
+{
+	typedef BOOL (WINAPI *GetProcessMemoryInfoProc)( HANDLE, PPROCESS_MEMORY_COUNTERS, DWORD );
+	static HMODULE s_psapi = NULL;
+	static GetProcessMemoryInfoProc s_getProcessMemoryInfo = NULL;
+	if (s_psapi == NULL)
+	{
+		s_psapi = LoadLibrary( "psapi.dll" );
+		if (s_psapi)
+			s_getProcessMemoryInfo = (GetProcessMemoryInfoProc)GetProcAddress( s_psapi, "GetProcessMemoryInfo" );
+	}
+
+	PROCESS_MEMORY_COUNTERS counters;
+	if (s_getProcessMemoryInfo == NULL || !s_getProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof(counters) ))
+		return 0;
+	return (Int)(counters.PeakWorkingSetSize / 1024);
+}
+#endif
+
+/// the files loadMapINI() reads from a map's directory, so startNewGame can prefetch them
+static const char *s_mapDirectoryFiles[] = { "map.ini", "solo.ini", "map.str", "AssetUsage.txt" };
+enum { MAP_DIRECTORY_FILE_COUNT = sizeof(s_mapDirectoryFiles) / sizeof(s_mapDirectoryFiles[0]) };
 
 
 // ------------------------------------------------------------------------------------------------
@@ -282,6 +315,7 @@ void GameLogic::setDefaults( Bool loadingSaveGame )
 		(*it)->friend_setIndexInLogic(-1);
 	}
 	m_sleepyUpdates.clear();
+	m_sleepyPriorities.clear();
 	m_curUpdateModule = NULL;
 
 	//
@@ -1161,6 +1195,27 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 
 	}  // end if
 
+	// start reading (and unpacking) the map on the prefetch threads while the load
+	// screen comes up, along with the files loadMapINI() reads from the map's directory.
+	// anything that's a local file, like a save's map, gets skipped.  (only files we can
+	// name up front get prefetched; the art a map uses isn't known until it's loaded.)
+	PrefetchFileList prefetchList;
+	prefetchList.push_back( TheGlobalData->m_mapName );
+	TheFileSystem->prefetchFiles( prefetchList, TRUE );
+
+	char mapDirectory[_MAX_PATH];
+	if (TheMapCache && getMapDirectory( TheGlobalData->m_mapName, mapDirectory ))
+	{
+		prefetchList.clear();
+		for (Int i = 0; i < MAP_DIRECTORY_FILE_COUNT; ++i)
+		{
+			AsciiString name;
+			name.format( "%s\\%s", mapDirectory, s_mapDirectoryFiles[i] );
+			prefetchList.push_back( name );
+		}
+		TheFileSystem->prefetchFiles( prefetchList, FALSE );
+	}
+
 	m_rankLevelLimit = 1000;	// this is reset every game.
 	setDefaults( loadingSaveGame );
 	TheWritableGlobalData->m_loadScreenRender = TRUE;	///< mark it so only a few select things are rendered during load	
@@ -1287,11 +1342,27 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 	// reset the frame counter
 	m_frame = 0;
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// how long the map itself takes to load, and how much memory it pulls in, to judge
+	// the archive mapping and prefetching by.
+	LARGE_INTEGER mapLoadStart, mapLoadEnd, mapLoadFreq;
+	QueryPerformanceFrequency( &mapLoadFreq );
+	QueryPerformanceCounter( &mapLoadStart );
+	Int peakKBBeforeMapLoad = getPeakWorkingSetKB();
+#endif
+
 	// before loading the map, load the map.ini file in the same directory.
 	loadMapINI( TheGlobalData->m_mapName );
 
 	// load a map
 	TheTerrainLogic->loadMap( TheGlobalData->m_mapName, false );
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	QueryPerformanceCounter( &mapLoadEnd );
+	DEBUG_LOG(("Map load: '%s' took %.1f ms, peak working set %d KB (%d KB before the map)\n", 
+		TheGlobalData->m_mapName.str(), (mapLoadEnd.QuadPart - mapLoadStart.QuadPart) * 1000.0 / (double)mapLoadFreq.QuadPart,
+		getPeakWorkingSetKB(), peakKBBeforeMapLoad));
+#endif
 	// anytime the world's size changes, must reset the partition mgr
 	//ThePartitionManager->init();
 
@@ -2349,6 +2420,9 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 	//setGameLoading(FALSE);
 	setLoadingMap( FALSE );
 
+	// whatever the load didn't open by now, it isn't going to.
+	TheFileSystem->flushPrefetches();
+
 #ifdef DUMP_PERF_STATS
 	GetPrecisionTimer(&endTime64);
 	sprintf(Buf,"Total startnewgame=%f\n",((double)(endTime64-startTime64)/(double)(freq64)*1000.0));
@@ -2387,18 +2461,11 @@ static void findAndSelectCommandCenter(Object *obj, void* alreadyFound)
 
 
 // ------------------------------------------------------------------------------------------------
+/** Find the directory a map's map.ini, solo.ini, etc live in.  Returns FALSE if mapName
+	* is too short to be a map. */
 // ------------------------------------------------------------------------------------------------
-void GameLogic::loadMapINI( AsciiString mapName )
+static Bool getMapDirectory( AsciiString mapName, char *filename )
 {
-
-	if (!TheMapCache) {
-		// Need the map cache to get the map and user map directories.
-		return;
-	}
-
-	char filename[_MAX_PATH];
-	char fullFledgeFilename[_MAX_PATH];
-
 	memset(filename, 0, _MAX_PATH);
 	strcpy(filename, mapName.str());
 
@@ -2414,7 +2481,7 @@ void GameLogic::loadMapINI( AsciiString mapName )
 	// sanity
 	int length = (int)(int)strlen(filename);
 	if (length < 4) { 
-		return;
+		return FALSE;
 	}
 
 	// back up over the ".map" extension and to the first directory separator
@@ -2424,6 +2491,25 @@ void GameLogic::loadMapINI( AsciiString mapName )
 	}
 	*extension = 0;
 
+	return TRUE;
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void GameLogic::loadMapINI( AsciiString mapName )
+{
+
+	if (!TheMapCache) {
+		// Need the map cache to get the map and user map directories.
+		return;
+	}
+
+	char filename[_MAX_PATH];
+	char fullFledgeFilename[_MAX_PATH];
+
+	if (!getMapDirectory(mapName, filename)) {
+		return;
+	}
 
 	sprintf(fullFledgeFilename, "%s\\map.ini", filename);
 	if (TheFileSystem->doesFileExist(fullFledgeFilename)) {
@@ -2722,6 +2808,7 @@ inline void GameLogic::validateSleepyUpdate() const
 #endif
 #ifdef SLEEPY_DEBUG
 	int sz = (int)m_sleepyUpdates.size();
+	DEBUG_ASSERTCRASH(m_sleepyPriorities.size() == sz, ("sleepy priority count mismatch"));
 	if (sz == 0)
 		return;
 
@@ -2734,6 +2821,7 @@ inline void GameLogic::validateSleepyUpdate() const
 	for (i = 0; i < sz; ++i)
 	{
 		DEBUG_ASSERTCRASH(m_sleepyUpdates[i]->friend_getIndexInLogic() == i, ("index mismatch: expected %d, got %d\n",i,m_sleepyUpdates[i]->friend_getIndexInLogic()));
+		DEBUG_ASSERTCRASH(m_sleepyPriorities[i] == m_sleepyUpdates[i]->friend_getPriority(), ("stale sleepy priority at %d\n",i));
 		UnsignedInt pri = m_sleepyUpdates[i]->friend_getPriority();
 		if (i > 0)
 		{
@@ -2771,25 +2859,25 @@ void GameLogic::eraseSleepyUpdate(Int i)
 	if (i < final)
 	{
 		m_sleepyUpdates[i] = m_sleepyUpdates[final];
+		m_sleepyPriorities[i] = m_sleepyPriorities[final];
 		m_sleepyUpdates[i]->friend_setIndexInLogic(i);
 		m_sleepyUpdates.pop_back();
+		m_sleepyPriorities.pop_back();
 		rebalanceSleepyUpdate(i);
 	}
 	else
 	{
 		m_sleepyUpdates.pop_back();
+		m_sleepyPriorities.pop_back();
 	}
 }
 
 // ------------------------------------------------------------------------------------------------
-inline Bool isLowerPriority(const UpdateModulePtr a, const UpdateModulePtr b)
+inline Bool isLowerPriority(UnsignedInt f1, UnsignedInt f2)
 {
-	// return true iff a is lower pri than b.
+	// return true iff f1 is lower pri than f2.
 	// remember: lower ordinal value means higher priority.
 	// therefore, higher ordinal value means lower priority.
-	DEBUG_ASSERTCRASH(a && b, ("these may no longer be null"));
-	UnsignedInt f1 = a->friend_getPriority();
-	UnsignedInt f2 = b->friend_getPriority();
 	return f1 > f2;
 }
 
@@ -2801,13 +2889,17 @@ Int GameLogic::rebalanceParentSleepyUpdate(Int i)
 	DEBUG_ASSERTCRASH(i >= 0 && i < m_sleepyUpdates.size(), ("bad sleepy idx"));
 
 	Int parent = ((i+1)>>1)-1;
-	while (parent >= 0 && isLowerPriority(m_sleepyUpdates[parent], m_sleepyUpdates[i]))
+	while (parent >= 0 && isLowerPriority(m_sleepyPriorities[parent], m_sleepyPriorities[i]))
 	{
 		UpdateModulePtr a = m_sleepyUpdates[parent];
 		UpdateModulePtr b = m_sleepyUpdates[i];
+		UnsignedInt pa = m_sleepyPriorities[parent];
+		UnsignedInt pb = m_sleepyPriorities[i];
 
 		m_sleepyUpdates[i] = a;
 		m_sleepyUpdates[parent] = b;
+		m_sleepyPriorities[i] = pa;
+		m_sleepyPriorities[parent] = pb;
 
 		a->friend_setIndexInLogic(i);
 		b->friend_setIndexInLogic(parent);
@@ -2831,12 +2923,16 @@ Int GameLogic::rebalanceChildSleepyUpdate(Int i)
 // max efficiency. I have left the pristine non-unrolled
 // version present for clarity. (Yes, this is worth doing.) (srj) 
 #if 1
-	UpdateModulePtr* pI = &m_sleepyUpdates[i];
+	UpdateModulePtr* pUpdates = m_sleepyUpdates.data();
+	UnsignedInt* pPris = m_sleepyPriorities.data();
+	UnsignedInt* pI = pPris + i;
+	UnsignedInt pri = *pI;		// the priority of the item we're sinking; it goes wherever we stop.
+	UpdateModulePtr u = pUpdates[i];
 
 	// our children are i*2 and i*2+1
   Int child = ((i+1)<<1)-1;
-	UpdateModulePtr* pChild = m_sleepyUpdates.data() + child;
-	UpdateModulePtr* pSZ = m_sleepyUpdates.data() + m_sleepyUpdates.size();	// yes, this is off the end.
+	UnsignedInt* pChild = pPris + child;
+	UnsignedInt* pSZ = pPris + m_sleepyPriorities.size();	// yes, this is off the end.
 
   while (pChild < pSZ) 
 	{
@@ -2848,27 +2944,29 @@ Int GameLogic::rebalanceChildSleepyUpdate(Int i)
 		}
 
 		// if we're higher-pri than our children, we're done.
-		if (!isLowerPriority(*pI, *pChild))
+		if (!isLowerPriority(pri, *pChild))
 		{
 			break;
 		}
 
-		// doh. swap with the highest-pri child we have.
-		UpdateModulePtr a = *pChild;
-		UpdateModulePtr b = *pI;
-
-		*pI = a;
-		*pChild = b;
+		// doh. move the highest-pri child we have up into our spot. (we don't bother 
+		// writing ourselves into the child's spot until we know where we stop.)
+		UpdateModulePtr a = pUpdates[child];
 
+		*pI = *pChild;
+		pUpdates[i] = a;
 		a->friend_setIndexInLogic(i);
-		b->friend_setIndexInLogic(child);
 
 		i = child;
 		pI = pChild;
 
 		child = ((i+1)<<1)-1;
-		pChild = m_sleepyUpdates.data() + child;
+		pChild = pPris + child;
   }
+
+	*pI = pri;
+	pUpdates[i] = u;
+	u->friend_setIndexInLogic(i);
 #else
 	// our children are i*2 and i*2+1
 	Int sz = m_sleepyUpdates.size();
@@ -2876,11 +2974,11 @@ Int GameLogic::rebalanceChildSleepyUpdate(Int i)
   while (child < sz) 
 	{
 		// choose the higher-priority of the two children; we must be higher-pri than that.
-		if (child < sz-1 && isLowerPriority(m_sleepyUpdates[child], m_sleepyUpdates[child+1]))
+		if (child < sz-1 && isLowerPriority(m_sleepyPriorities[child], m_sleepyPriorities[child+1]))
       ++child;
 		
 		// if we're higher-pri than our children, we're done.
-		if (!isLowerPriority(m_sleepyUpdates[i], m_sleepyUpdates[child]))
+		if (!isLowerPriority(m_sleepyPriorities[i], m_sleepyPriorities[child]))
 		{
 			break;
 		}
@@ -2888,9 +2986,13 @@ Int GameLogic::rebalanceChildSleepyUpdate(Int i)
 		// doh. swap with the highest-pri child we have.
 		UpdateModulePtr a = m_sleepyUpdates[child];
 		UpdateModulePtr b = m_sleepyUpdates[i];
+		UnsignedInt pa = m_sleepyPriorities[child];
+		UnsignedInt pb = m_sleepyPriorities[i];
 
 		m_sleepyUpdates[i] = a;
 		m_sleepyUpdates[child] = b;
+		m_sleepyPriorities[i] = pa;
+		m_sleepyPriorities[child] = pb;
 
 		a->friend_setIndexInLogic(i);
 		b->friend_setIndexInLogic(child);
@@ -2915,6 +3017,9 @@ void GameLogic::remakeSleepyUpdate()
 {
 	USE_PERF_TIMER(SleepyMaintenance)
 
+	if (m_sleepyUpdates.empty())
+		return;
+
 	Int parent = (int)m_sleepyUpdates.size() / 2;
   while (true) 
 	{
@@ -2935,6 +3040,7 @@ void GameLogic::pushSleepyUpdate(UpdateModulePtr u)
 	DEBUG_ASSERTCRASH(u != NULL, ("You may not pass null for sleepy update info"));
 
 	m_sleepyUpdates.push_back(u);
+	m_sleepyPriorities.push_back(u->friend_getPriority());
 	u->friend_setIndexInLogic((int)m_sleepyUpdates.size() - 1);
 	
 	rebalanceParentSleepyUpdate((int)m_sleepyUpdates.size()-1);
@@ -2966,13 +3072,16 @@ void GameLogic::popSleepyUpdate()
 	if (sz > 1)
 	{
 		m_sleepyUpdates[0] = m_sleepyUpdates[sz-1];
+		m_sleepyPriorities[0] = m_sleepyPriorities[sz-1];
 		m_sleepyUpdates[0]->friend_setIndexInLogic(0);
 		m_sleepyUpdates.pop_back();
+		m_sleepyPriorities.pop_back();
 		rebalanceChildSleepyUpdate(0);
 	}
 	else
 	{
 		m_sleepyUpdates.pop_back();
+		m_sleepyPriorities.pop_back();
 	}
 }
 
@@ -3022,6 +3131,7 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 
 		// update the value.
 		u->friend_setNextCallFrame(whenToWakeUp);
+		m_sleepyPriorities[idx] = u->friend_getPriority();
 
 		// rebalance.
 		rebalanceSleepyUpdate(idx);
@@ -3718,6 +3828,11 @@ void GameLogic::update( void )
 	}
 #endif
 
+	// note that the sleepy updates must be run one at a time, in heap order. even "local" modules
+	// (physics, stealth, etc.) draw from the shared GameLogicRandomValue sequence, move themselves
+	// in the partition manager, and wake or damage other objects' modules, and any change in the
+	// order of those side effects changes the CRC. running some of them concurrently would need
+	// every such call deferred and replayed in the exact serial order.
 	{
 		while (!m_sleepyUpdates.empty())
 		{
@@ -3755,8 +3870,11 @@ void GameLogic::update( void )
 
 			}
 
-			// else defer it till next frame and re-push it
+			// else defer it till next frame and re-push it. (anything registered during its
+			// update may have bubbled above it, so refresh the cached key in its own slot.
+			// Rebalance from the top like we always have, to keep the update order the same.)
 			u->friend_setNextCallFrame(now + sleepLen);
+			m_sleepyPriorities[u->friend_getIndexInLogic()] = u->friend_getPriority();
 			rebalanceSleepyUpdate(0);
 		}
 	}
@@ -5041,6 +5159,7 @@ void GameLogic::loadPostProcess( void )
 		(*it)->friend_setIndexInLogic(-1);
 	}
 	m_sleepyUpdates.clear();
+	m_sleepyPriorities.clear();
 #ifdef ALLOW_NONSLEEPY_UPDATES
 	m_normalUpdates.clear();
 #else
@@ -5083,6 +5202,7 @@ void GameLogic::loadPostProcess( void )
 #endif
 			{
 				m_sleepyUpdates.push_back(u);
+				m_sleepyPriorities.push_back(u->friend_getPriority());
 				u->friend_setIndexInLogic((int)m_sleepyUpdates.size() - 1);
 			}
 				
@@ -687,6 +687,8 @@ void CheckNumPlayersOnline( void )
 
 DWORD WINAPI asyncGethostbynameThreadFunc( void * szName )
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	//HOSTENT *he = gethostbyname( (const char *)szName );
 	PADDRINFOA he = 0;
 	getaddrinfo((const char*)szName, 0, 0, &he);
@@ -266,6 +266,8 @@ GPProfile GameSpyBuddyMessageQueue::getLocalProfileID( void )
 
 void BuddyThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	try {
 	//_set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
 	GPConnection gpCon;
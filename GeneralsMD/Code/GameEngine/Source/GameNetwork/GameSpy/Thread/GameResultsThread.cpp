@@ -209,6 +209,8 @@ Bool GameResultsQueue::areGameResultsBeingSent( void )
 
 void GameResultsThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	try {
 #if 0
 	_set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
@@ -1190,6 +1190,8 @@ static UnsignedInt localIP = 0;
 
 void PeerThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	try {
 	//_set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
 
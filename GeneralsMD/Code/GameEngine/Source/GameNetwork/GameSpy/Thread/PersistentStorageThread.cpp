@@ -822,6 +822,8 @@ static void getPreorderCallback(int localid, int profileid, persisttype_t type,
 
 void PSThreadClass::Thread_Function()
 {
+	ScopedThreadMemoryPoolCaches threadCaches;
+
 	try {
 	//_set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
 	/*********
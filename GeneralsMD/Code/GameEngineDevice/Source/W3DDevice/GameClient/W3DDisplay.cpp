@@ -282,6 +282,9 @@ void StatDumpClass::dumpStats( Bool brief, Bool flagSpikes )
 	fprintf(m_fp, "Partition Manager Statistics:\n");
 	fprintf(m_fp, "  Total time for object scans this frame is %.5f msec\n", gcoTimeThisFrameTotal);
 	fprintf(m_fp, "  Avg time per object scan this frame is %.5f msec\n", gcoTimeThisFrameAvg);
+	Int contactPairs, contactRejects, contactHits;
+	ThePartitionManager->getPMContactStats(contactPairs, contactRejects, contactHits);
+	fprintf(m_fp, "  Contact pairs this frame: %d (%d broadphase rejects, %d hits)\n", contactPairs, contactRejects, contactHits);
 	fprintf( m_fp, "\n" );
 
 	// setup texture stats
@@ -50,6 +50,7 @@ Win32BIGFileSystem::Win32BIGFileSystem() : ArchiveFileSystem() {
 }
 
 Win32BIGFileSystem::~Win32BIGFileSystem() {
+	Win32BIGFile::logMappingStats();
 }
 
 void Win32BIGFileSystem::init() {
@@ -82,6 +83,27 @@ void Win32BIGFileSystem::update() {
 void Win32BIGFileSystem::postProcessLoad() {
 }
 
+// split the archived path in buffer into directory and file name and add it to the archive.
+// buffer gets chopped up in the process.
+static void addArchivedFile(ArchiveFile *archiveFile, ArchivedFileInfo *fileInfo, char *buffer)
+{
+	Int filenameIndex = strlen(buffer);
+	while ((filenameIndex >= 0) && (buffer[filenameIndex] != '\\') && (buffer[filenameIndex] != '/')) {
+		--filenameIndex;
+	}
+
+	fileInfo->m_filename = (char *)(buffer + filenameIndex + 1);
+	fileInfo->m_filename.toLower();
+	buffer[filenameIndex + 1] = 0;
+
+	AsciiString path;
+	path = buffer;
+
+//	DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - adding file %s%s to archive file %s\n", path.str(), fileInfo->m_filename.str(), fileInfo->m_archiveFilename.str()));
+
+	archiveFile->addFile(path, fileInfo);
+}
+
 ArchiveFile * Win32BIGFileSystem::openArchiveFile(const Char *filename) {
 	File *fp = TheLocalFileSystem->openFile(filename, File::READ | File::BINARY);
 	AsciiString archiveFileName;
@@ -90,7 +112,7 @@ ArchiveFile * Win32BIGFileSystem::openArchiveFile(const Char *filename) {
 	Int archiveFileSize = 0;
 	Int numLittleFiles = 0;
 
-	ArchiveFile *archiveFile = new Win32BIGFile;
+	Win32BIGFile *archiveFile = new Win32BIGFile;
 
 	DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - opening BIG file %s\n", filename));
 
@@ -129,53 +151,99 @@ ArchiveFile * Win32BIGFileSystem::openArchiveFile(const Char *filename) {
 //		buffer[(4-i)-1] = t;
 //	}
 
+	// the last header field is where the directory listing ends and the file data starts.
+	Int directoryEnd = 0;
+	fp->read(&directoryEnd, 4);
+	directoryEnd = ntohl(directoryEnd);
+
 	// seek to the beginning of the directory listing.
 	fp->seek(0x10, File::START);
 	// read in each directory listing.
 	ArchivedFileInfo *fileInfo = new ArchivedFileInfo;
-
-	for (Int i = 0; i < numLittleFiles; ++i) {
-		Int filesize = 0;
-		Int fileOffset = 0;
-		fp->read(&fileOffset, 4);
-		fp->read(&filesize, 4);
-
-		filesize = ntohl(filesize);
-		fileOffset = ntohl(fileOffset);
-
-		fileInfo->m_archiveFilename = archiveFileName;
-		fileInfo->m_offset = fileOffset;
-		fileInfo->m_size = filesize;
-		
-		// read in the path name of the file.
-		Int pathIndex = -1;
-		do {
-			++pathIndex;
-			fp->read(buffer + pathIndex, 1);
-		} while (buffer[pathIndex] != 0);
-
-		Int filenameIndex = pathIndex;
-		while ((filenameIndex >= 0) && (buffer[filenameIndex] != '\\') && (buffer[filenameIndex] != '/')) {
-			--filenameIndex;
+	fileInfo->m_archiveFilename = archiveFileName;
+
+	// pull the whole listing in with one read and parse it in memory.  if the header
+	// doesn't look right, fall back to reading it an entry at a time.
+	Bool parsed = FALSE;
+	Int directorySize = directoryEnd - 0x10;
+	char *directory = NULL;
+	if ((directorySize > 0) && (directoryEnd <= fp->size())) {
+		directory = NEW char[directorySize];
+		fp->seek(0x10, File::START);
+		if (fp->read(directory, directorySize) != directorySize) {
+			delete[] directory;
+			directory = NULL;
 		}
+	}
 
-		fileInfo->m_filename = (char *)(buffer + filenameIndex + 1);
-		fileInfo->m_filename.toLower();
-		buffer[filenameIndex + 1] = 0;
+	if (directory != NULL) {
+		const char *cur = directory;
+		const char *end = directory + directorySize;
+		Int i;
+		for (i = 0; i < numLittleFiles; ++i) {
+			if (end - cur < 9) {
+				break;
+			}
+
+			Int fileOffset = 0;
+			Int filesize = 0;
+			memcpy(&fileOffset, cur, 4);
+			memcpy(&filesize, cur + 4, 4);
+			cur += 8;
+
+			const char *name = cur;
+			while ((cur < end) && (*cur != 0)) {
+				++cur;
+			}
+			if ((cur == end) || (cur - name >= _MAX_PATH)) {
+				break;
+			}
+			memcpy(buffer, name, cur - name + 1);
+			++cur;
+
+			fileInfo->m_offset = ntohl(fileOffset);
+			fileInfo->m_size = ntohl(filesize);
+			addArchivedFile(archiveFile, fileInfo, buffer);
+		}
 
-		AsciiString path;
-		path = buffer;
+		delete[] directory;
+		directory = NULL;
 
-		AsciiString debugpath;
-		debugpath = path;
-		debugpath.concat(fileInfo->m_filename);
-//		DEBUG_LOG(("Win32BIGFileSystem::openArchiveFile - adding file %s to archive file %s, file number %d\n", debugpath.str(), fileInfo->m_archiveFilename.str(), i));
+		// entries already added just get added again identically by the slow path.
+		parsed = (i == numLittleFiles);
+		DEBUG_ASSERTLOG(parsed, ("Win32BIGFileSystem::openArchiveFile - directory of %s ends early at file %d of %d, rereading it the slow way\n", filename, i, numLittleFiles));
+	}
 
-		archiveFile->addFile(path, fileInfo);
+	if (!parsed) {
+		fp->seek(0x10, File::START);
+		for (Int i = 0; i < numLittleFiles; ++i) {
+			Int filesize = 0;
+			Int fileOffset = 0;
+			fp->read(&fileOffset, 4);
+			fp->read(&filesize, 4);
+
+			filesize = ntohl(filesize);
+			fileOffset = ntohl(fileOffset);
+
+			fileInfo->m_offset = fileOffset;
+			fileInfo->m_size = filesize;
+			
+			// read in the path name of the file.
+			Int pathIndex = -1;
+			do {
+				++pathIndex;
+				fp->read(buffer + pathIndex, 1);
+			} while (buffer[pathIndex] != 0);
+
+			addArchivedFile(archiveFile, fileInfo, buffer);
+		}
 	}
 
 	archiveFile->attachFile(fp);
 
+	// files opened from here on come out of the mapping; fp is still what we fall back on.
+	archiveFile->mapArchive(filename);
+
 	delete fileInfo;
 	fileInfo = NULL;
 
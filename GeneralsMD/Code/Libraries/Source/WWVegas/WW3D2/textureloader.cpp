@@ -999,6 +999,9 @@ void LoaderThreadClass::Thread_Function(void)
 
 		Switch_Thread();
 	}
+
+	// anything we cached from the game's memory pools goes back before we go.
+	releaseThreadW3DMemPoolCaches();
 }
 
 
@@ -115,6 +115,7 @@ extern void* createW3DMemPool(const char *poolName, int allocationSize);
 extern void* allocateFromW3DMemPool(void* p, int allocationSize);
 extern void* allocateFromW3DMemPool(void* p, int allocationSize, const char* msg, int unused);
 extern void freeFromW3DMemPool(void* pool, void* p);
+extern void releaseThreadW3DMemPoolCaches();	///< call from a thread that's done with the pools, before it exits
 
 // ----------------------------------------------------------------------------
 #define W3DMPO_GLUE(ARGCLASS) \